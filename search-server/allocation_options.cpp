@@ -0,0 +1,23 @@
+#include "allocation_options.h"
+
+#include <stdexcept>
+
+void CheckAllocationOptions(const AllocationOptions &options) {
+    if (options.text_chunk_size == 0
+        || (options.strategy != AllocationStrategy::HEAP && options.strategy != AllocationStrategy::POOL
+            && options.strategy != AllocationStrategy::MONOTONIC)) {
+        throw std::invalid_argument("Invalid allocation options");
+    }
+}
+
+std::unique_ptr<std::pmr::memory_resource> MakeMemoryResource(const AllocationOptions &options) {
+    CheckAllocationOptions(options);
+    switch (options.strategy) {
+        case AllocationStrategy::POOL:
+            return std::make_unique<std::pmr::unsynchronized_pool_resource>();
+        case AllocationStrategy::MONOTONIC:
+            return std::make_unique<std::pmr::monotonic_buffer_resource>();
+        default:
+            return nullptr;
+    }
+}
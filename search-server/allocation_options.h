@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+#include "text_arena.h"
+
+// Откуда берут память словари документов сервера: ID документов и частоты их слов
+enum class AllocationStrategy {
+    HEAP, // Каждый узел - отдельное выделение из общей кучи
+    // Узлы из пулов блоков одного размера, освобождённые узлы переиспользуются пулом
+    POOL,
+    // Узлы подряд из больших буферов. Память удалённых документов не освобождается
+    // до уничтожения сервера, поэтому подходит для индексов, из которых почти не удаляют
+    MONOTONIC,
+};
+
+struct AllocationOptions {
+    AllocationStrategy strategy = AllocationStrategy::POOL;
+    // Размер буферов, в которые подряд копируются тексты документов
+    size_t text_chunk_size = TextArena::DEFAULT_CHUNK_SIZE;
+};
+
+// Бросит std::invalid_argument, если параметры некорректны
+void CheckAllocationOptions(const AllocationOptions &options);
+
+// Создаст ресурс памяти для стратегии. Ресурс не потокобезопасен: им пользуется только
+// пишущий поток. Для HEAP вернёт пустой указатель - используется std::pmr::new_delete_resource()
+std::unique_ptr<std::pmr::memory_resource> MakeMemoryResource(const AllocationOptions &options);
@@ -0,0 +1,127 @@
+#include "bit_packing.h"
+
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr size_t LANE_COUNT = 4;
+constexpr size_t LANE_SIZE = PACKED_BLOCK_SIZE / LANE_COUNT;
+
+uint32_t GetMask(uint32_t bits) {
+    return bits >= 32 ? ~uint32_t{0} : (uint32_t{1} << bits) - 1;
+}
+
+} // namespace
+
+uint32_t GetRequiredBits(const uint32_t *values) {
+    uint32_t all_bits = 0;
+    for (size_t i = 0; i < PACKED_BLOCK_SIZE; ++i) {
+        all_bits |= values[i];
+    }
+    uint32_t bits = 0;
+    while (all_bits != 0) {
+        ++bits;
+        all_bits >>= 1;
+    }
+    return bits;
+}
+
+void PackBlock(const uint32_t *values, uint32_t bits, uint32_t *packed) {
+    std::fill(packed, packed + GetPackedWordCount(bits), 0);
+    for (size_t lane = 0; lane < LANE_COUNT; ++lane) {
+        for (size_t j = 0; j < LANE_SIZE; ++j) {
+            const uint32_t value = values[LANE_COUNT * j + lane];
+            const size_t bit = j * bits;
+            const size_t word = bit / 32;
+            const uint32_t shift = bit % 32;
+            if (bits == 0) {
+                continue;
+            }
+            packed[LANE_COUNT * word + lane] |= value << shift;
+            if (shift + bits > 32) {
+                packed[LANE_COUNT * (word + 1) + lane] |= value >> (32 - shift);
+            }
+        }
+    }
+}
+
+#ifdef __SSE2__
+
+void UnpackBlock(const uint32_t *packed, uint32_t bits, uint32_t *values) {
+    auto *out = reinterpret_cast<__m128i *>(values);
+    if (bits == 0) {
+        for (size_t j = 0; j < LANE_SIZE; ++j) {
+            _mm_storeu_si128(out + j, _mm_setzero_si128());
+        }
+        return;
+    }
+    const auto *in = reinterpret_cast<const __m128i *>(packed);
+    const __m128i mask = _mm_set1_epi32(static_cast<int>(GetMask(bits)));
+    for (size_t j = 0; j < LANE_SIZE; ++j) {
+        const size_t bit = j * bits;
+        const size_t word = bit / 32;
+        const uint32_t shift = bit % 32;
+        __m128i value = _mm_srl_epi32(_mm_loadu_si128(in + word), _mm_cvtsi32_si128(static_cast<int>(shift)));
+        if (shift + bits > 32) {
+            const __m128i high = _mm_sll_epi32(_mm_loadu_si128(in + word + 1),
+                                               _mm_cvtsi32_si128(static_cast<int>(32 - shift)));
+            value = _mm_or_si128(value, high);
+        }
+        _mm_storeu_si128(out + j, _mm_and_si128(value, mask));
+    }
+}
+
+void DecodeDeltas(uint32_t *values, uint32_t base) {
+    auto *data = reinterpret_cast<__m128i *>(values);
+    __m128i previous = _mm_set1_epi32(static_cast<int>(base));
+    for (size_t j = 0; j < LANE_SIZE; ++j) {
+        previous = _mm_add_epi32(previous, _mm_loadu_si128(data + j));
+        _mm_storeu_si128(data + j, previous);
+    }
+}
+
+#else
+
+void UnpackBlock(const uint32_t *packed, uint32_t bits, uint32_t *values) {
+    const uint32_t mask = GetMask(bits);
+    for (size_t lane = 0; lane < LANE_COUNT; ++lane) {
+        for (size_t j = 0; j < LANE_SIZE; ++j) {
+            if (bits == 0) {
+                values[LANE_COUNT * j + lane] = 0;
+                continue;
+            }
+            const size_t bit = j * bits;
+            const size_t word = bit / 32;
+            const uint32_t shift = bit % 32;
+            uint32_t value = packed[LANE_COUNT * word + lane] >> shift;
+            if (shift + bits > 32) {
+                value |= packed[LANE_COUNT * (word + 1) + lane] << (32 - shift);
+            }
+            values[LANE_COUNT * j + lane] = value & mask;
+        }
+    }
+}
+
+void DecodeDeltas(uint32_t *values, uint32_t base) {
+    for (size_t i = 0; i < LANE_COUNT; ++i) {
+        values[i] += base;
+    }
+    for (size_t i = LANE_COUNT; i < PACKED_BLOCK_SIZE; ++i) {
+        values[i] += values[i - LANE_COUNT];
+    }
+}
+
+#endif
+
+void EncodeDeltas(const uint32_t *values, uint32_t base, uint32_t *deltas) {
+    for (size_t i = 0; i < LANE_COUNT; ++i) {
+        deltas[i] = values[i] - base;
+    }
+    for (size_t i = LANE_COUNT; i < PACKED_BLOCK_SIZE; ++i) {
+        deltas[i] = values[i] - values[i - LANE_COUNT];
+    }
+}
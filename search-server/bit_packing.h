@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Упаковка блоков по PACKED_BLOCK_SIZE чисел фиксированной разрядностью (схема SIMD-BP128).
+// Числа раскладываются по четырём дорожкам: число i попадает в дорожку i % 4,
+// и слово k дорожки l хранится по индексу 4 * k + l. Блок разрядности bits
+// занимает 4 * bits слов, и распаковка обрабатывает все дорожки одной SSE2-командой.
+// Без SSE2 используется скалярная распаковка того же формата
+constexpr size_t PACKED_BLOCK_SIZE = 128;
+
+// Число бит, достаточное для записи каждого из PACKED_BLOCK_SIZE чисел
+uint32_t GetRequiredBits(const uint32_t *values);
+
+// Число 32-битных слов в упакованном блоке
+inline size_t GetPackedWordCount(uint32_t bits) {
+    return 4 * static_cast<size_t>(bits);
+}
+
+void PackBlock(const uint32_t *values, uint32_t bits, uint32_t *packed);
+
+void UnpackBlock(const uint32_t *packed, uint32_t bits, uint32_t *values);
+
+// Разности с шагом 4: deltas[i] = values[i] - values[i - 4], для первых четырёх - values[i] - base.
+// Такие разности восстанавливаются сложением целых векторов без перестановок внутри них.
+// values должны возрастать и быть не меньше base
+void EncodeDeltas(const uint32_t *values, uint32_t base, uint32_t *deltas);
+
+// Восстановит значения из разностей на месте
+void DecodeDeltas(uint32_t *values, uint32_t base);
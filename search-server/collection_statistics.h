@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cmath>
+
+// Документная частота слова и её логарифм
+struct TermStatistics {
+    int document_freq = 0;
+    double log_document_freq = 0.0;
+
+    // Учтёт добавление (count > 0) или удаление (count < 0) документов со словом
+    void AddDocuments(int count) {
+        document_freq += count;
+        log_document_freq = document_freq > 0 ? std::log(document_freq) : 0.0;
+    }
+};
+
+// Статистика коллекции документов. Запрос берёт её из своей версии индекса,
+// поэтому все слова запроса оцениваются по одному состоянию индекса
+struct CollectionStatistics {
+    int document_count = 0;
+    double log_document_count = 0.0;
+
+    void AddDocuments(int count) {
+        document_count += count;
+        log_document_count = document_count > 0 ? std::log(document_count) : 0.0;
+    }
+
+    // IDF = log(N / df) = log(N) - log(df), оба логарифма посчитаны заранее
+    double ComputeInverseDocumentFreq(const TermStatistics &term) const {
+        return log_document_count - term.log_document_freq;
+    }
+};
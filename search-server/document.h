@@ -1,9 +1,15 @@
 #pragma once
 
+#include <cmath>
 #include <iostream>
+#include <string_view>
+#include <vector>
 
 const int MAX_RESULT_DOCUMENT_COUNT = 5;
 
+// Релевантности, отличающиеся меньше чем на EPSILON, считаются равными
+inline constexpr double EPSILON = 1e-6;
+
 struct Document {
     Document() = default;
     Document(int id, double relevance, int rating)
@@ -22,4 +28,20 @@ enum class DocumentStatus {
     REMOVED,
 };
 
+// Документ для пакетного добавления в сервер
+struct NewDocument {
+    int id = 0;
+    std::string_view text;
+    DocumentStatus status = DocumentStatus::ACTUAL;
+    std::vector<int> ratings;
+};
+
+// Порядок выдачи: по убыванию релевантности, при равной релевантности - по убыванию рейтинга
+inline bool IsMoreRelevant(const Document &lhs, const Document &rhs) {
+    if (std::abs(lhs.relevance - rhs.relevance) < EPSILON) {
+        return lhs.rating > rhs.rating;
+    }
+    return lhs.relevance > rhs.relevance;
+}
+
 std::ostream& operator<<(std::ostream& out, const Document& document);
\ No newline at end of file
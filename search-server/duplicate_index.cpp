@@ -0,0 +1,60 @@
+#include "duplicate_index.h"
+
+#include <string>
+
+#include "hash_mixing.h"
+
+DuplicateDocumentError::DuplicateDocumentError(int document_id, int original_id)
+        : std::invalid_argument("Document " + std::to_string(document_id)
+                                + " duplicates document " + std::to_string(original_id)),
+          document_id_(document_id),
+          original_id_(original_id) {
+}
+
+int DuplicateDocumentError::GetDocumentId() const {
+    return document_id_;
+}
+
+int DuplicateDocumentError::GetOriginalId() const {
+    return original_id_;
+}
+
+void TermSetFingerprint::Add(TermId term_id) {
+    low += MixBits(term_id + 0x9E3779B97F4A7C15ULL);
+    high += MixBits(term_id ^ 0xD6E8FEB86659FD93ULL);
+}
+
+bool TermSetFingerprint::operator<(const TermSetFingerprint &other) const {
+    return low != other.low ? low < other.low : high < other.high;
+}
+
+bool TermSetFingerprint::operator==(const TermSetFingerprint &other) const {
+    return low == other.low && high == other.high;
+}
+
+size_t TermSetFingerprintHasher::operator()(const TermSetFingerprint &fingerprint) const {
+    // Половины отпечатка уже перемешаны, достаточно одной из них
+    return static_cast<size_t>(fingerprint.low);
+}
+
+void DuplicateIndex::Insert(const TermSetFingerprint &fingerprint, int document_id) {
+    document_ids_.emplace(fingerprint, document_id);
+}
+
+void DuplicateIndex::Erase(const TermSetFingerprint &fingerprint, int document_id) {
+    const auto [first, last] = document_ids_.equal_range(fingerprint);
+    for (auto it = first; it != last; ++it) {
+        if (it->second == document_id) {
+            document_ids_.erase(it);
+            return;
+        }
+    }
+}
+
+void DuplicateIndex::Clear() {
+    document_ids_.clear();
+}
+
+size_t DuplicateIndex::size() const {
+    return document_ids_.size();
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+
+#include "lexicon.h"
+
+// Что делать с документом, набор слов которого совпадает с набором слов документа в сервере
+enum class DuplicatePolicy {
+    ALLOW, // Документ добавляется, отпечатки наборов слов не хранятся
+    // Добавление бросает DuplicateDocumentError с ID имеющейся копии и не меняет сервер
+    REJECT,
+};
+
+class DuplicateDocumentError : public std::invalid_argument {
+public:
+    DuplicateDocumentError(int document_id, int original_id);
+
+    int GetDocumentId() const;
+
+    // ID документа сервера с тем же набором слов
+    int GetOriginalId() const;
+
+private:
+    int document_id_;
+    int original_id_;
+};
+
+// Отпечаток набора слов - сумма хешей слов в двух независимых 64-битных половинах.
+// Сумма не зависит от порядка слов, поэтому отпечаток собирается по одному слову
+struct TermSetFingerprint {
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    // Добавит слово. Каждое слово набора добавляется один раз
+    void Add(TermId term_id);
+
+    bool operator<(const TermSetFingerprint &other) const;
+
+    bool operator==(const TermSetFingerprint &other) const;
+};
+
+struct TermSetFingerprintHasher {
+    size_t operator()(const TermSetFingerprint &fingerprint) const;
+};
+
+template<typename TermSet>
+TermSetFingerprint ComputeTermSetFingerprint(const TermSet &terms) {
+    TermSetFingerprint fingerprint;
+    for (const auto &term : terms) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(term)>, TermId>) {
+            fingerprint.Add(term);
+        } else {
+            fingerprint.Add(term.first);
+        }
+    }
+    return fingerprint;
+}
+
+// Отпечатки наборов слов документов сервера. Документы с одинаковым отпечатком
+// при поиске копии сравниваются по словам, поэтому совпадение отпечатков разных
+// наборов не принимается за копию
+class DuplicateIndex {
+public:
+    // Вернёт ID документа с отпечатком fingerprint, для которого has_same_words(document_id) истинно
+    template<typename SameWordsPredicate>
+    std::optional<int> Find(const TermSetFingerprint &fingerprint, SameWordsPredicate has_same_words) const {
+        const auto [first, last] = document_ids_.equal_range(fingerprint);
+        for (auto it = first; it != last; ++it) {
+            if (has_same_words(it->second)) {
+                return it->second;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void Insert(const TermSetFingerprint &fingerprint, int document_id);
+
+    void Erase(const TermSetFingerprint &fingerprint, int document_id);
+
+    void Clear();
+
+    size_t size() const;
+
+private:
+    std::unordered_multimap<TermSetFingerprint, int, TermSetFingerprintHasher> document_ids_;
+};
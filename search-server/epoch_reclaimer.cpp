@@ -0,0 +1,59 @@
+#include "epoch_reclaimer.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <thread>
+
+EpochReclaimer::Guard::Guard(std::atomic<uint64_t> &slot)
+        : slot_(slot) {
+}
+
+EpochReclaimer::Guard::~Guard() {
+    slot_.store(0, std::memory_order_release);
+}
+
+EpochReclaimer::Guard EpochReclaimer::Pin() const {
+    // Поток начинает поиск с ячейки, которую занимал в прошлый раз
+    static thread_local size_t hint = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    // Эпоха читается до занятия ячейки: если писатель сменит её раньше, чем читатель
+    // прочитает опубликованный объект, читатель увидит уже новый объект
+    const uint64_t epoch = epoch_.load();
+    const size_t first_slot = hint % SLOT_COUNT;
+    for (size_t i = 0;; ++i) {
+        const size_t slot_index = (first_slot + i) % SLOT_COUNT;
+        auto &slot = slots_[slot_index].epoch;
+        uint64_t expected = 0;
+        if (slot.load(std::memory_order_relaxed) == 0 && slot.compare_exchange_strong(expected, epoch)) {
+            hint = slot_index;
+            return Guard(slot);
+        }
+        if ((i + 1) % SLOT_COUNT == 0) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void EpochReclaimer::Retire(std::shared_ptr<const void> object) {
+    if (!object) {
+        return;
+    }
+    // Читатели, закрепившие эпоху не раньше новой, объект уже не увидят
+    const uint64_t epoch = epoch_.fetch_add(1) + 1;
+    retired_.emplace_back(epoch, std::move(object));
+}
+
+void EpochReclaimer::Collect() {
+    uint64_t min_epoch = std::numeric_limits<uint64_t>::max();
+    for (const auto &slot: slots_) {
+        const uint64_t epoch = slot.epoch.load();
+        if (epoch != 0) {
+            min_epoch = std::min(min_epoch, epoch);
+        }
+    }
+    retired_.erase(std::remove_if(retired_.begin(), retired_.end(),
+                                  [min_epoch](const auto &retired) {
+                                      return retired.first <= min_epoch;
+                                  }),
+                   retired_.end());
+}
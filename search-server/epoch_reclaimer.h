@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Отложенное освобождение объектов, которые читают другие потоки, по эпохам.
+// Читатель на время работы с опубликованным объектом закрепляет эпоху (Pin),
+// писатель после замены объекта откладывает его освобождение (Retire) до момента,
+// когда все читатели, закрепившие эпоху раньше замены, закончат работу.
+// Читатели не берут блокировок: закрепление - запись эпохи в свободную ячейку.
+// Retire и Collect вызывает только поток писателя
+class EpochReclaimer {
+public:
+    // Закреплённая эпоха читателя, освобождается в деструкторе
+    class Guard {
+    public:
+        explicit Guard(std::atomic<uint64_t> &slot);
+
+        Guard(const Guard &) = delete;
+
+        Guard &operator=(const Guard &) = delete;
+
+        ~Guard();
+
+    private:
+        std::atomic<uint64_t> &slot_;
+    };
+
+    // Закрепит текущую эпоху. Опубликованные после этого объекты читатель видит
+    // уже после их публикации, а объекты, снятые с публикации позже, не будут освобождены,
+    // пока жив Guard
+    [[nodiscard]] Guard Pin() const;
+
+    // Освободит объект, когда его не сможет читать ни один читатель.
+    // Вызывается после того, как объект снят с публикации
+    void Retire(std::shared_ptr<const void> object);
+
+    // Освободит объекты, которые больше никто не читает
+    void Collect();
+
+private:
+    // Больше SLOT_COUNT одновременных читателей ждут освобождения ячейки
+    static constexpr size_t SLOT_COUNT = 128;
+
+    // Эпоха читателя или 0 для свободной ячейки. Ячейки на разных строках кэша,
+    // чтобы читатели разных потоков не мешали друг другу
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{0};
+    };
+
+    mutable std::array<Slot, SLOT_COUNT> slots_;
+    std::atomic<uint64_t> epoch_{1};
+    std::vector<std::pair<uint64_t, std::shared_ptr<const void>>> retired_; // Эпоха снятия - объект
+};
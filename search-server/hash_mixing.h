@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+// Перемешает биты значения (финализатор splitmix64): каждый бит результата зависит
+// от всех битов value, поэтому близкие значения дают непохожие хеши.
+// Независимые хеши одного значения получают, перемешивая его с разными затравками
+inline uint64_t MixBits(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
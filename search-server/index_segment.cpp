@@ -0,0 +1,181 @@
+#include "index_segment.h"
+
+#include <algorithm>
+
+IndexSegment::IndexSegment(int first_slot)
+        : first_slot_(first_slot) {
+}
+
+IndexSegment IndexSegment::Merge(const std::vector<std::shared_ptr<const IndexSegment>> &segments,
+                                 const std::vector<bool> &removed_slots) {
+    IndexSegment merged(segments.front()->first_slot_);
+    // Новые номера оставшихся документов относительно начала слитого сегмента
+    std::vector<uint32_t> new_offsets(removed_slots.size());
+    std::vector<TermId> term_ids;
+    for (const auto &segment: segments) {
+        const int first_offset = segment->first_slot_ - merged.first_slot_;
+        for (size_t i = 0; i < segment->inverse_word_counts_.size(); ++i) {
+            if (!removed_slots[first_offset + i]) {
+                new_offsets[first_offset + i] = static_cast<uint32_t>(merged.inverse_word_counts_.size());
+                merged.inverse_word_counts_.push_back(segment->inverse_word_counts_[i]);
+            }
+        }
+        segment->postings_.ForEach([&term_ids](TermId term_id, const std::shared_ptr<PostingList> &) {
+            term_ids.push_back(term_id);
+        });
+    }
+    std::sort(term_ids.begin(), term_ids.end());
+    term_ids.erase(std::unique(term_ids.begin(), term_ids.end()), term_ids.end());
+
+    for (const TermId term_id: term_ids) {
+        PostingList *merged_postings = nullptr;
+        for (const auto &segment: segments) {
+            // Номера курсора - смещения от начала диапазона
+            const int first_offset = segment->first_slot_ - merged.first_slot_;
+            for (PostingList::Cursor cursor(segment->GetPostings(term_id), nullptr, first_offset); !cursor.IsEnd();
+                 cursor.Next()) {
+                const int offset = cursor.GetDocumentId();
+                if (removed_slots[offset]) {
+                    continue;
+                }
+                if (merged_postings == nullptr) {
+                    merged_postings = &merged.AddTerm(term_id);
+                }
+                const uint32_t new_offset = new_offsets[offset];
+                const uint32_t term_count = cursor.GetTermCount();
+                merged_postings->Add(static_cast<int>(new_offset), term_count,
+                                     term_count * merged.inverse_word_counts_[new_offset]);
+            }
+        }
+    }
+    merged.Compact();
+    return merged;
+}
+
+int IndexSegment::GetFirstSlot() const {
+    return first_slot_;
+}
+
+void IndexSegment::SetFirstSlot(int first_slot) {
+    first_slot_ = first_slot;
+}
+
+int IndexSegment::GetLastSlot() const {
+    return first_slot_ + static_cast<int>(inverse_word_counts_.size());
+}
+
+size_t IndexSegment::GetDocumentCount() const {
+    return inverse_word_counts_.size();
+}
+
+const double *IndexSegment::GetInverseWordCounts() const {
+    return inverse_word_counts_.data();
+}
+
+const PostingList &IndexSegment::GetPostings(TermId term_id) const {
+    static const PostingList empty_postings;
+    const auto *postings = postings_.Find(term_id);
+    return postings == nullptr ? empty_postings : **postings;
+}
+
+PostingList &IndexSegment::GetPostings(TermId term_id) {
+    return *postings_[term_id];
+}
+
+PostingList &IndexSegment::AddTerm(TermId term_id) {
+    auto &postings = postings_.GetMutable(term_id);
+    if (!postings) {
+        postings = std::make_shared<PostingList>();
+    } else if (postings.use_count() > 1) {
+        postings = std::make_shared<PostingList>(*postings);
+    }
+    return *postings;
+}
+
+void IndexSegment::AddDocument(double inverse_word_count) {
+    inverse_word_counts_.push_back(inverse_word_count);
+}
+
+void IndexSegment::Compact() {
+    std::vector<TermId> term_ids;
+    term_ids.reserve(postings_.size());
+    postings_.ForEach([&term_ids](TermId term_id, const std::shared_ptr<PostingList> &) {
+        term_ids.push_back(term_id);
+    });
+    for (const TermId term_id: term_ids) {
+        AddTerm(term_id).Compact();
+    }
+    inverse_word_counts_.shrink_to_fit();
+}
+
+void IndexSegment::Save(SnapshotWriter &writer) const {
+    // Списки пишутся отдельным блоком, перед которым стоит оглавление: ID слов по возрастанию
+    // и начала их списков в блоке. По оглавлению отображённый сегмент находит список без разбора блока
+    std::vector<TermId> term_ids;
+    std::vector<uint64_t> posting_offsets;
+    SnapshotWriter postings_writer;
+    postings_.ForEach([&](TermId term_id, const std::shared_ptr<PostingList> &postings) {
+        term_ids.push_back(term_id);
+        postings_writer.Align(8);
+        posting_offsets.push_back(postings_writer.GetSize());
+        postings->Save(postings_writer);
+    });
+    writer.Write(first_slot_);
+    writer.WriteArray(inverse_word_counts_);
+    writer.WriteArray(term_ids);
+    writer.WriteArray(posting_offsets);
+    writer.WriteString(postings_writer.GetData());
+}
+
+IndexSegment IndexSegment::Load(SnapshotReader &reader) {
+    const auto mapped = MappedIndexSegment::Load(reader);
+    IndexSegment segment(mapped.first_slot_);
+    segment.inverse_word_counts_.assign(mapped.inverse_word_counts_.begin(), mapped.inverse_word_counts_.end());
+    for (size_t i = 0; i < mapped.term_ids_.size(); ++i) {
+        if (mapped.posting_offsets_[i] > mapped.postings_.size()) {
+            ThrowSnapshotCorrupted();
+        }
+        SnapshotReader postings_reader(mapped.postings_.substr(mapped.posting_offsets_[i]));
+        segment.postings_.GetMutable(mapped.term_ids_[i]) =
+                std::make_shared<PostingList>(PostingList::Load(postings_reader));
+    }
+    return segment;
+}
+
+MappedIndexSegment MappedIndexSegment::Load(SnapshotReader &reader) {
+    MappedIndexSegment segment;
+    segment.first_slot_ = reader.Read<int>();
+    segment.inverse_word_counts_ = reader.ReadArrayView<double>();
+    segment.term_ids_ = reader.ReadArrayView<TermId>();
+    segment.posting_offsets_ = reader.ReadArrayView<uint64_t>();
+    segment.postings_ = reader.ReadString();
+    if (segment.posting_offsets_.size() != segment.term_ids_.size()) {
+        ThrowSnapshotCorrupted();
+    }
+    return segment;
+}
+
+int MappedIndexSegment::GetFirstSlot() const {
+    return first_slot_;
+}
+
+int MappedIndexSegment::GetLastSlot() const {
+    return first_slot_ + static_cast<int>(inverse_word_counts_.size());
+}
+
+size_t MappedIndexSegment::GetDocumentCount() const {
+    return inverse_word_counts_.size();
+}
+
+const double *MappedIndexSegment::GetInverseWordCounts() const {
+    return inverse_word_counts_.data();
+}
+
+PostingList::View MappedIndexSegment::GetPostings(TermId term_id) const {
+    const auto it = std::lower_bound(term_ids_.begin(), term_ids_.end(), term_id);
+    if (it == term_ids_.end() || *it != term_id) {
+        return {};
+    }
+    SnapshotReader reader(postings_.substr(posting_offsets_[it - term_ids_.begin()]));
+    return PostingList::View::Load(reader);
+}
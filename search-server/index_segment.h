@@ -0,0 +1,105 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "index_snapshot.h"
+#include "lexicon.h"
+#include "posting_list.h"
+#include "shared_vector.h"
+#include "versioned_array.h"
+
+// Сегмент индекса: списки вхождений слов в документы с номерами [first_slot, last_slot)
+// и обратные длины этих документов. Списки хранят номера документов относительно first_slot,
+// поэтому сегмент сдвигается по номерам без переписывания списков.
+// Сегменты делят пространство номеров документов на непересекающиеся диапазоны.
+// Новые документы дописываются в изменяемый сегмент, заполненный сегмент
+// сжимается и больше не меняется, а неизменяемые сегменты сливаются в фоне.
+// Удаления сегмент не хранит: удалённые документы отбрасываются при слиянии,
+// а оставшиеся получают номера подряд.
+// Копии сегмента делят списки вхождений и обратные длины документов. Изменяемый список
+// при первом пополнении после копирования сегмента заменяется своей копией, которая делит
+// массивы с прежней и дописывает в них документы за её пределами. Поэтому копирование
+// сегмента и пополнение после него не зависят от размера сегмента, а копию можно читать
+// из других потоков
+class IndexSegment {
+public:
+    explicit IndexSegment(int first_slot = 0);
+
+    // Сольёт подряд идущие сегменты в один, пропустив удалённые документы.
+    // removed_slots - признаки удаления документов объединяемого диапазона,
+    // индексируются номером документа минус первый номер диапазона.
+    // Оставшиеся документы в прежнем порядке получают номера подряд с первого номера диапазона
+    static IndexSegment Merge(const std::vector<std::shared_ptr<const IndexSegment>> &segments,
+                              const std::vector<bool> &removed_slots);
+
+    int GetFirstSlot() const;
+
+    // Сдвинет диапазон номеров документов сегмента, не меняя списков
+    void SetFirstSlot(int first_slot);
+
+    int GetLastSlot() const;
+
+    size_t GetDocumentCount() const;
+
+    // Обратные длины документов, индексируются номером документа минус первый номер сегмента
+    const double *GetInverseWordCounts() const;
+
+    // Вернёт пустой список, если слова в сегменте нет.
+    // Номера документов в списке отсчитываются от первого номера сегмента
+    const PostingList &GetPostings(TermId term_id) const;
+
+    // Список вхождений слова, для которого AddTerm вызван после последнего копирования
+    // сегмента. Списки разных слов можно пополнять из разных потоков
+    PostingList &GetPostings(TermId term_id);
+
+    // Вернёт список вхождений слова для пополнения, создав его при необходимости
+    PostingList &AddTerm(TermId term_id);
+
+    // Добавит в сегмент документ с номером GetLastSlot(). В списки вхождений он
+    // добавляется с номером GetDocumentCount() до вызова
+    void AddDocument(double inverse_word_count);
+
+    // Сожмёт списки перед заморозкой сегмента
+    void Compact();
+
+    // Запишет сегмент в секцию снимка индекса
+    void Save(SnapshotWriter &writer) const;
+
+    // Прочитает сегмент, записанный Save. Бросит std::runtime_error, если данные повреждены
+    static IndexSegment Load(SnapshotReader &reader);
+
+private:
+    int first_slot_ = 0;
+    SharedVector<double> inverse_word_counts_;
+    VersionedArray<std::shared_ptr<PostingList>, 4> postings_; // ID слова - список вхождений
+};
+
+// Сегмент индекса в отображённом в память снимке, записанный IndexSegment::Save.
+// Списки вхождений читаются прямо из снимка, слово ищется двоичным поиском по его ID
+class MappedIndexSegment {
+public:
+    // Прочитает заголовок сегмента, не копируя и не проверяя списки вхождений
+    static MappedIndexSegment Load(SnapshotReader &reader);
+
+    int GetFirstSlot() const;
+
+    int GetLastSlot() const;
+
+    size_t GetDocumentCount() const;
+
+    const double *GetInverseWordCounts() const;
+
+    // Вернёт пустой список, если слова в сегменте нет.
+    // Номера документов в списке отсчитываются от первого номера сегмента
+    PostingList::View GetPostings(TermId term_id) const;
+
+private:
+    friend class IndexSegment;
+
+    int first_slot_ = 0;
+    SnapshotArray<double> inverse_word_counts_;
+    SnapshotArray<TermId> term_ids_; // По возрастанию
+    SnapshotArray<uint64_t> posting_offsets_; // Начала списков слов term_ids_ в postings_
+    std::string_view postings_;
+};
@@ -0,0 +1,217 @@
+#include "index_snapshot.h"
+
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char SIGNATURE[8] = {'S', 'R', 'C', 'H', 'I', 'D', 'X', '\0'};
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr size_t SECTION_ALIGNMENT = 8;
+
+struct FileHeader {
+    char signature[8];
+    uint32_t format_version;
+    uint32_t byte_order_mark;
+    uint64_t section_count;
+};
+
+struct SectionHeader {
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t checksum;
+};
+
+uint64_t RotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+} // namespace
+
+void ThrowSnapshotCorrupted() {
+    throw std::runtime_error("Index snapshot is corrupted");
+}
+
+void SnapshotWriter::WriteString(std::string_view value) {
+    Write<uint64_t>(value.size());
+    data_.append(value);
+}
+
+void SnapshotWriter::Align(size_t alignment) {
+    data_.resize((data_.size() + alignment - 1) / alignment * alignment, '\0');
+}
+
+size_t SnapshotWriter::GetSize() const {
+    return data_.size();
+}
+
+std::string &SnapshotWriter::GetData() {
+    return data_;
+}
+
+SnapshotReader::SnapshotReader(std::string_view data)
+        : begin_(data.data()), data_(data) {
+}
+
+std::string_view SnapshotReader::ReadString() {
+    const auto size = Read<uint64_t>();
+    return Take(size);
+}
+
+void SnapshotReader::Align(size_t alignment) {
+    const auto position = static_cast<size_t>(data_.data() - begin_);
+    Take((position + alignment - 1) / alignment * alignment - position);
+}
+
+bool SnapshotReader::IsEnd() const {
+    return data_.empty();
+}
+
+std::string_view SnapshotReader::Take(size_t size) {
+    if (size > data_.size()) {
+        ThrowSnapshotCorrupted();
+    }
+    const std::string_view result = data_.substr(0, size);
+    data_.remove_prefix(size);
+    return result;
+}
+
+uint64_t ComputeSnapshotChecksum(std::string_view data) {
+    static constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87ull;
+    static constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+
+    // Четыре независимые цепочки, чтобы умножения шли параллельно
+    uint64_t lanes[4] = {PRIME_1, PRIME_2, ~PRIME_1, ~PRIME_2};
+    size_t pos = 0;
+    for (; pos + 32 <= data.size(); pos += 32) {
+        for (int lane = 0; lane < 4; ++lane) {
+            uint64_t word;
+            std::memcpy(&word, data.data() + pos + lane * 8, 8);
+            lanes[lane] = RotateLeft(lanes[lane] + word * PRIME_2, 31) * PRIME_1;
+        }
+    }
+    uint64_t hash = data.size() * PRIME_1;
+    for (const uint64_t lane : lanes) {
+        hash = RotateLeft(hash ^ lane, 27) * PRIME_1 + PRIME_2;
+    }
+    for (; pos < data.size(); ++pos) {
+        hash = RotateLeft(hash ^ static_cast<uint8_t>(data[pos]) * PRIME_1, 11) * PRIME_2;
+    }
+    hash ^= hash >> 33;
+    hash *= PRIME_2;
+    return hash ^ (hash >> 29);
+}
+
+void WriteSnapshotFile(const std::string &path,
+                       const std::vector<std::pair<SnapshotSectionType, std::string>> &sections) {
+    FileHeader header{};
+    std::memcpy(header.signature, SIGNATURE, sizeof(SIGNATURE));
+    header.format_version = SNAPSHOT_FORMAT_VERSION;
+    header.byte_order_mark = BYTE_ORDER_MARK;
+    header.section_count = sections.size();
+
+    std::vector<SectionHeader> section_headers;
+    section_headers.reserve(sections.size());
+    const auto get_padding = [](size_t size) {
+        return (SECTION_ALIGNMENT - size % SECTION_ALIGNMENT) % SECTION_ALIGNMENT;
+    };
+    uint64_t offset = sizeof(FileHeader) + sections.size() * sizeof(SectionHeader);
+    for (const auto &[type, data] : sections) {
+        section_headers.push_back({static_cast<uint32_t>(type), 0, offset, data.size(),
+                                   ComputeSnapshotChecksum(data)});
+        offset += data.size() + get_padding(data.size());
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(section_headers.data()),
+              static_cast<std::streamsize>(section_headers.size() * sizeof(SectionHeader)));
+    static constexpr char PADDING[SECTION_ALIGNMENT] = {};
+    for (const auto &[type, data] : sections) {
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        out.write(PADDING, static_cast<std::streamsize>(get_padding(data.size())));
+    }
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("Failed to write index snapshot " + path);
+    }
+}
+
+std::vector<SnapshotSection> ReadSnapshotFile(const std::string &path, std::string &data) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        throw std::runtime_error("Failed to open index snapshot " + path);
+    }
+    data.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!in) {
+        throw std::runtime_error("Failed to read index snapshot " + path);
+    }
+    return ParseSnapshot(data);
+}
+
+std::vector<SnapshotSection> ParseSnapshot(std::string_view data) {
+    SnapshotReader reader(data);
+    const auto header = reader.Read<FileHeader>();
+    if (std::memcmp(header.signature, SIGNATURE, sizeof(SIGNATURE)) != 0
+        || header.format_version != SNAPSHOT_FORMAT_VERSION || header.byte_order_mark != BYTE_ORDER_MARK) {
+        throw std::runtime_error("Unsupported index snapshot format");
+    }
+    if (header.section_count > data.size() / sizeof(SectionHeader)) {
+        ThrowSnapshotCorrupted();
+    }
+
+    std::vector<SnapshotSection> sections;
+    sections.reserve(header.section_count);
+    for (uint64_t i = 0; i < header.section_count; ++i) {
+        const auto section = reader.Read<SectionHeader>();
+        if (section.offset > data.size() || section.size > data.size() - section.offset
+            || section.offset % SECTION_ALIGNMENT != 0) {
+            ThrowSnapshotCorrupted();
+        }
+        sections.push_back({static_cast<SnapshotSectionType>(section.type),
+                            data.substr(section.offset, section.size), section.checksum});
+    }
+    return sections;
+}
+
+void CheckSnapshotSection(const SnapshotSection &section) {
+    if (ComputeSnapshotChecksum(section.data) != section.checksum) {
+        ThrowSnapshotCorrupted();
+    }
+}
+
+MappedSnapshotFile::MappedSnapshotFile(const std::string &path) {
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        throw std::runtime_error("Failed to open index snapshot " + path);
+    }
+    struct stat file_stat{};
+    if (fstat(file, &file_stat) != 0 || file_stat.st_size == 0) {
+        close(file);
+        throw std::runtime_error("Failed to map index snapshot " + path);
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+    void *data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, file, 0);
+    // Отображение остаётся действительным и после закрытия файла
+    close(file);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Failed to map index snapshot " + path);
+    }
+    data_ = static_cast<const char *>(data);
+}
+
+MappedSnapshotFile::~MappedSnapshotFile() {
+    munmap(const_cast<char *>(data_), size_);
+}
+
+std::string_view MappedSnapshotFile::GetData() const {
+    return {data_, size_};
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Двоичный снимок индекса на диске.
+// Файл: заголовок (сигнатура, версия формата, признак порядка байт, число секций),
+// таблица секций (тип, смещение, размер, контрольная сумма) и данные секций.
+// Секции независимы, поэтому их можно проверять и разбирать параллельно.
+// Числа хранятся в порядке байт машины, файл с другим порядком не загружается.
+// Секции начинаются с границы 8 байт, а значения внутри секции выровнены по своему размеру,
+// поэтому массивы отображённого в память файла можно читать на месте
+inline constexpr uint32_t SNAPSHOT_FORMAT_VERSION = 2;
+
+enum class SnapshotSectionType : uint32_t {
+    STOP_WORDS = 1,
+    LEXICON = 2,
+    SERVER_STATE = 3, // Правила слияния, статистика коллекции и удаления в изменяемом сегменте
+    TERM_STATISTICS = 4, // Документные частоты слов и их логарифмы
+    DOCUMENTS = 5,
+    DOCUMENT_TEXTS = 6, // Необязательная
+    WORD_FREQUENCIES = 7,
+    SEGMENT = 8, // По секции на сегмент, изменяемый сегмент - последний
+};
+
+struct SnapshotSection {
+    SnapshotSectionType type;
+    std::string_view data;
+    uint64_t checksum;
+};
+
+// Массив внутри данных снимка или другого непрерывного хранилища
+template<typename T>
+class SnapshotArray {
+public:
+    SnapshotArray() = default;
+
+    SnapshotArray(const T *data, size_t size)
+            : data_(data), size_(size) {
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    const T &operator[](size_t index) const {
+        return data_[index];
+    }
+
+    const T &back() const {
+        return data_[size_ - 1];
+    }
+
+    const T *data() const {
+        return data_;
+    }
+
+    const T *begin() const {
+        return data_;
+    }
+
+    const T *end() const {
+        return data_ + size_;
+    }
+
+private:
+    const T *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Бросит std::runtime_error о повреждённом снимке
+[[noreturn]] void ThrowSnapshotCorrupted();
+
+// Пишет значения подряд в буфер секции, выравнивая каждое значение по его размеру
+class SnapshotWriter {
+public:
+    template<typename T>
+    void Write(const T &value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        Align(alignof(T));
+        data_.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    // Размер и элементы массива: std::vector или другого непрерывного хранилища с data() и size()
+    template<typename Array>
+    void WriteArray(const Array &values) {
+        using T = std::remove_cv_t<std::remove_reference_t<decltype(*values.data())>>;
+        static_assert(std::is_trivially_copyable_v<T>);
+        Write<uint64_t>(values.size());
+        data_.append(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+    }
+
+    // Данные строки начинаются с границы 8 байт, поэтому в строку можно вложить
+    // содержимое другого SnapshotWriter
+    void WriteString(std::string_view value);
+
+    // Дополнит буфер нулями до границы alignment байт
+    void Align(size_t alignment);
+
+    size_t GetSize() const;
+
+    std::string &GetData();
+
+private:
+    std::string data_;
+};
+
+// Читает значения в том порядке, в котором их записал SnapshotWriter.
+// Бросит std::runtime_error, если данных не хватает
+class SnapshotReader {
+public:
+    explicit SnapshotReader(std::string_view data);
+
+    template<typename T>
+    T Read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        Align(alignof(T));
+        T value;
+        std::memcpy(&value, Take(sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    void ReadArray(std::vector<T> &values) {
+        const auto array = ReadArrayView<T>();
+        values.assign(array.begin(), array.end());
+    }
+
+    // Массив указывает в данные снимка, которые должны быть выровнены по границе 8 байт
+    template<typename T>
+    SnapshotArray<T> ReadArrayView() {
+        static_assert(std::is_trivially_copyable_v<T> && alignof(T) <= 8);
+        const auto size = Read<uint64_t>();
+        if (size > data_.size() / sizeof(T)) {
+            ThrowSnapshotCorrupted();
+        }
+        return {reinterpret_cast<const T *>(Take(size * sizeof(T)).data()), static_cast<size_t>(size)};
+    }
+
+    // Строка указывает в данные снимка
+    std::string_view ReadString();
+
+    void Align(size_t alignment);
+
+    bool IsEnd() const;
+
+private:
+    const char *begin_;
+    std::string_view data_;
+
+    std::string_view Take(size_t size);
+};
+
+// Контрольная сумма данных секции: хеш по 8 байт за шаг
+uint64_t ComputeSnapshotChecksum(std::string_view data);
+
+// Запишет секции в файл. Бросит std::runtime_error при ошибке записи
+void WriteSnapshotFile(const std::string &path,
+                       const std::vector<std::pair<SnapshotSectionType, std::string>> &sections);
+
+// Прочитает файл в data и разберёт таблицу секций, не проверяя контрольные суммы.
+// Бросит std::runtime_error, если файл не читается или это не снимок индекса этой версии
+std::vector<SnapshotSection> ReadSnapshotFile(const std::string &path, std::string &data);
+
+// Разберёт таблицу секций снимка, уже находящегося в памяти
+std::vector<SnapshotSection> ParseSnapshot(std::string_view data);
+
+// Файл снимка, отображённый в память только для чтения. Страницы файла читаются
+// с диска при первом обращении и делятся между процессами, отобразившими тот же файл
+class MappedSnapshotFile {
+public:
+    // Бросит std::runtime_error, если файл не удалось отобразить
+    explicit MappedSnapshotFile(const std::string &path);
+
+    MappedSnapshotFile(const MappedSnapshotFile &) = delete;
+
+    MappedSnapshotFile &operator=(const MappedSnapshotFile &) = delete;
+
+    ~MappedSnapshotFile();
+
+    std::string_view GetData() const;
+
+private:
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Бросит std::runtime_error, если контрольная сумма секции не совпадает с записанной
+void CheckSnapshotSection(const SnapshotSection &section);
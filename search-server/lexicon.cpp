@@ -0,0 +1,145 @@
+#include "lexicon.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+std::optional<TermId> Lexicon::Snapshot::Find(std::string_view term) const {
+    for (uint32_t cell = GetFirstCell(term);; cell = (cell + 1) & cell_mask_) {
+        const TermId *term_id = term_ids_.Find(cell);
+        if (term_id == nullptr) {
+            return std::nullopt;
+        }
+        if (terms_[*term_id] == term) {
+            return *term_id;
+        }
+    }
+}
+
+std::string_view Lexicon::Snapshot::GetTerm(TermId term_id) const {
+    return terms_[term_id];
+}
+
+size_t Lexicon::Snapshot::size() const {
+    return terms_.size();
+}
+
+uint32_t Lexicon::Snapshot::GetFirstCell(std::string_view term) const {
+    return static_cast<uint32_t>(std::hash<std::string_view>{}(term)) & cell_mask_;
+}
+
+void Lexicon::Snapshot::Add(std::string_view term, TermId term_id) {
+    terms_.GetMutable(term_id) = term;
+    if (2 * terms_.size() > size_t{cell_mask_} + 1) {
+        // Старые снимки сохраняют свою таблицу, новая строится из новых узлов
+        term_ids_ = {};
+        cell_mask_ = 2 * cell_mask_ + 1;
+        terms_.ForEach([this](TermId id, std::string_view stored) {
+            Insert(stored, id);
+        });
+        return;
+    }
+    Insert(term, term_id);
+}
+
+void Lexicon::Snapshot::Insert(std::string_view term, TermId term_id) {
+    uint32_t cell = GetFirstCell(term);
+    while (term_ids_.Find(cell) != nullptr) {
+        cell = (cell + 1) & cell_mask_;
+    }
+    term_ids_.GetMutable(cell) = term_id;
+}
+
+TermId Lexicon::Intern(std::string_view term) {
+    if (const auto it = term_to_id_.find(term); it != term_to_id_.end()) {
+        return it->second;
+    }
+    const auto term_id = static_cast<TermId>(terms_.size());
+    const std::string_view stored = terms_.emplace_back(term_arena_.Add(term));
+    term_to_id_.emplace(stored, term_id);
+    snapshot_.Add(stored, term_id);
+    return term_id;
+}
+
+std::optional<TermId> Lexicon::Find(std::string_view term) const {
+    if (const auto it = term_to_id_.find(term); it != term_to_id_.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+std::string_view Lexicon::GetTerm(TermId term_id) const {
+    return terms_[term_id];
+}
+
+size_t Lexicon::size() const {
+    return terms_.size();
+}
+
+const Lexicon::Snapshot &Lexicon::GetSnapshot() const {
+    return snapshot_;
+}
+
+void Lexicon::Save(SnapshotWriter &writer) const {
+    std::vector<uint64_t> term_offsets;
+    term_offsets.reserve(terms_.size());
+    SnapshotWriter terms_writer;
+    for (const auto &term : terms_) {
+        terms_writer.Align(8);
+        term_offsets.push_back(terms_writer.GetSize());
+        terms_writer.WriteString(term);
+    }
+    std::vector<TermId> sorted_term_ids(terms_.size());
+    std::iota(sorted_term_ids.begin(), sorted_term_ids.end(), 0);
+    std::sort(sorted_term_ids.begin(), sorted_term_ids.end(), [this](TermId lhs, TermId rhs) {
+        return terms_[lhs] < terms_[rhs];
+    });
+    writer.WriteArray(term_offsets);
+    writer.WriteArray(sorted_term_ids);
+    writer.WriteString(terms_writer.GetData());
+}
+
+void Lexicon::Load(SnapshotReader &reader, Lexicon &lexicon) {
+    const auto mapped = MappedLexicon::Load(reader);
+    for (TermId term_id = 0; term_id < mapped.size(); ++term_id) {
+        // Повтор слова сдвинул бы ID следующих слов
+        if (lexicon.Intern(mapped.GetTerm(term_id)) != term_id) {
+            ThrowSnapshotCorrupted();
+        }
+    }
+}
+
+MappedLexicon MappedLexicon::Load(SnapshotReader &reader) {
+    MappedLexicon lexicon;
+    lexicon.term_offsets_ = reader.ReadArrayView<uint64_t>();
+    lexicon.sorted_term_ids_ = reader.ReadArrayView<TermId>();
+    lexicon.terms_ = reader.ReadString();
+    if (lexicon.sorted_term_ids_.size() != lexicon.term_offsets_.size()) {
+        ThrowSnapshotCorrupted();
+    }
+    return lexicon;
+}
+
+std::optional<TermId> MappedLexicon::Find(std::string_view term) const {
+    const auto it = std::partition_point(sorted_term_ids_.begin(), sorted_term_ids_.end(),
+                                         [this, term](TermId term_id) {
+                                             return GetTerm(term_id) < term;
+                                         });
+    if (it == sorted_term_ids_.end() || GetTerm(*it) != term) {
+        return std::nullopt;
+    }
+    return *it;
+}
+
+std::string_view MappedLexicon::GetTerm(TermId term_id) const {
+    if (term_id >= term_offsets_.size() || term_offsets_[term_id] > terms_.size()) {
+        ThrowSnapshotCorrupted();
+    }
+    SnapshotReader reader(terms_.substr(term_offsets_[term_id]));
+    return reader.ReadString();
+}
+
+size_t MappedLexicon::size() const {
+    return term_offsets_.size();
+}
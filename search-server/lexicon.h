@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "index_snapshot.h"
+#include "text_arena.h"
+#include "versioned_array.h"
+
+// Плотный числовой идентификатор слова
+using TermId = uint32_t;
+
+// Словарь слов индекса. Каждое различное слово хранится в единственном
+// экземпляре и получает ID по порядку добавления. Слова из словаря
+// не удаляются, поэтому ссылки на них остаются валидными всё время жизни словаря.
+class Lexicon {
+public:
+    // Снимок словаря: слова, добавленные до его создания. Копируется дёшево,
+    // читать снимок можно из других потоков, пока словарь пополняется
+    class Snapshot {
+    public:
+        // Вернёт ID слова или пустое значение, если слова нет в снимке
+        std::optional<TermId> Find(std::string_view term) const;
+
+        std::string_view GetTerm(TermId term_id) const;
+
+        size_t size() const;
+
+    private:
+        friend class Lexicon;
+
+        VersionedArray<std::string_view> terms_; // ID слова - слово
+        // Хеш-таблица с открытой адресацией: ячейка по хешу слова - ID слова.
+        // Заполнена не больше чем наполовину, при росте строится заново
+        VersionedArray<TermId> term_ids_;
+        uint32_t cell_mask_ = 0;
+
+        uint32_t GetFirstCell(std::string_view term) const;
+
+        void Insert(std::string_view term, TermId term_id);
+
+        void Add(std::string_view term, TermId term_id);
+    };
+
+    // Вернёт ID слова, добавив его в словарь при необходимости
+    TermId Intern(std::string_view term);
+
+    // Вернёт ID слова или пустое значение, если слова нет в словаре
+    std::optional<TermId> Find(std::string_view term) const;
+
+    std::string_view GetTerm(TermId term_id) const;
+
+    size_t size() const;
+
+    // Снимок текущего состояния словаря
+    const Snapshot &GetSnapshot() const;
+
+    // Запишет слова в секцию снимка индекса в формате MappedLexicon
+    void Save(SnapshotWriter &writer) const;
+
+    // Прочитает слова, записанные Save. Бросит std::runtime_error, если данные повреждены
+    static void Load(SnapshotReader &reader, Lexicon &lexicon);
+
+private:
+    TextArena term_arena_; // Тексты слов подряд в больших буферах
+    std::vector<std::string_view> terms_;
+    std::unordered_map<std::string_view, TermId> term_to_id_;
+    Snapshot snapshot_;
+};
+
+// Словарь в отображённом в память снимке, записанный Lexicon::Save: начала слов по их ID
+// и ID слов в порядке возрастания слов. Слово ищется двоичным поиском
+class MappedLexicon {
+public:
+    // Прочитает оглавление словаря, не копируя слова
+    static MappedLexicon Load(SnapshotReader &reader);
+
+    // Вернёт ID слова или пустое значение, если слова нет в словаре
+    std::optional<TermId> Find(std::string_view term) const;
+
+    std::string_view GetTerm(TermId term_id) const;
+
+    size_t size() const;
+
+private:
+    SnapshotArray<uint64_t> term_offsets_; // ID слова - начало слова в terms_
+    SnapshotArray<TermId> sorted_term_ids_;
+    std::string_view terms_;
+};
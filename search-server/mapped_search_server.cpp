@@ -0,0 +1,128 @@
+#include "mapped_search_server.h"
+
+#include <algorithm>
+#include <set>
+
+MappedSearchServer::MappedSearchServer(const std::string &path)
+        : file_(path) {
+    std::set<std::string> stop_words;
+    bool has_lexicon = false;
+    bool has_state = false;
+    bool has_documents = false;
+    // Разбираются только оглавления секций, данные читаются запросами по мере надобности
+    for (const auto &section : ParseSnapshot(file_.GetData())) {
+        SnapshotReader reader(section.data);
+        switch (section.type) {
+            case SnapshotSectionType::STOP_WORDS:
+                for (auto word_count = reader.Read<uint64_t>(); word_count > 0; --word_count) {
+                    stop_words.emplace(reader.ReadString());
+                }
+                break;
+            case SnapshotSectionType::LEXICON:
+                version_.lexicon = MappedLexicon::Load(reader);
+                has_lexicon = true;
+                break;
+            case SnapshotSectionType::SERVER_STATE:
+                // Правила слияния снимку только для чтения не нужны
+                reader.Read<uint64_t>();
+                reader.Read<uint64_t>();
+                reader.Read<double>();
+                version_.collection_statistics.AddDocuments(reader.Read<int>());
+                has_state = true;
+                break;
+            case SnapshotSectionType::TERM_STATISTICS:
+                version_.term_statistics.document_freqs = reader.ReadArrayView<int>();
+                version_.term_statistics.log_document_freqs = reader.ReadArrayView<double>();
+                break;
+            case SnapshotSectionType::DOCUMENTS: {
+                auto &documents = version_.documents;
+                documents.ids = reader.ReadArrayView<int>();
+                documents.ratings = reader.ReadArrayView<int>();
+                documents.statuses = reader.ReadArrayView<int>();
+                documents.removed = reader.ReadArrayView<uint8_t>();
+                version_.document_slots.ids = reader.ReadArrayView<int>();
+                version_.document_slots.slots = reader.ReadArrayView<int>();
+                has_documents = true;
+                break;
+            }
+            case SnapshotSectionType::SEGMENT:
+                version_.segments.push_back(
+                        std::make_shared<const MappedIndexSegment>(MappedIndexSegment::Load(reader)));
+                break;
+            default:
+                break;
+        }
+    }
+
+    const auto &documents = version_.documents;
+    const auto slot_count = static_cast<int>(documents.ids.size());
+    if (!has_lexicon || !has_state || !has_documents || version_.segments.empty()
+        || version_.term_statistics.document_freqs.size() != version_.lexicon.size()
+        || version_.term_statistics.log_document_freqs.size() != version_.lexicon.size()
+        || documents.ratings.size() != documents.ids.size() || documents.statuses.size() != documents.ids.size()
+        || documents.removed.size() != documents.ids.size()
+        || version_.document_slots.slots.size() != version_.document_slots.ids.size()
+        || version_.segments.back()->GetLastSlot() != slot_count) {
+        ThrowSnapshotCorrupted();
+    }
+    for (size_t i = 0; i < version_.segments.size(); ++i) {
+        if (version_.segments[i]->GetFirstSlot() != (i == 0 ? 0 : version_.segments[i - 1]->GetLastSlot())) {
+            ThrowSnapshotCorrupted();
+        }
+    }
+    tokenizer_ = std::make_unique<const Tokenizer>(stop_words);
+}
+
+std::vector<Document> MappedSearchServer::FindTopDocuments(const std::string_view &raw_query,
+                                                           DocumentStatus status, size_t top_count) const {
+    return FindTopDocuments(std::execution::seq, raw_query, status, top_count);
+}
+
+std::vector<Document> MappedSearchServer::FindTopDocuments(const std::string_view &raw_query) const {
+    return FindTopDocuments(std::execution::seq, raw_query, DocumentStatus::ACTUAL);
+}
+
+int MappedSearchServer::GetDocumentCount() const {
+    return static_cast<int>(version_.document_slots.size());
+}
+
+std::tuple<std::vector<std::string_view>, DocumentStatus>
+MappedSearchServer::MatchDocument(const std::string_view raw_query, int document_id) const {
+    return MatchDocument(std::execution::seq, raw_query, document_id);
+}
+
+std::tuple<std::vector<std::string_view>, DocumentStatus>
+MappedSearchServer::MatchDocument(const std::execution::sequenced_policy &policy,
+                                  std::string_view raw_query, int document_id) const {
+    return SearchServer::MatchDocument(policy, *tokenizer_, version_, raw_query, document_id);
+}
+
+std::tuple<std::vector<std::string_view>, DocumentStatus>
+MappedSearchServer::MatchDocument(const std::execution::parallel_policy &policy,
+                                  std::string_view raw_query, int document_id) const {
+    return SearchServer::MatchDocument(policy, *tokenizer_, version_, raw_query, document_id);
+}
+
+TermStatistics MappedSearchServer::TermStatisticsView::operator[](TermId term_id) const {
+    return {document_freqs[term_id], log_document_freqs[term_id]};
+}
+
+MappedSearchServer::DocumentData MappedSearchServer::DocumentsView::operator[](int slot) const {
+    return {ids[slot], ratings[slot], static_cast<DocumentStatus>(statuses[slot]), removed[slot] != 0};
+}
+
+size_t MappedSearchServer::DocumentsView::size() const {
+    return ids.size();
+}
+
+int MappedSearchServer::DocumentSlotsView::at(int document_id) const {
+    const auto it = std::lower_bound(ids.begin(), ids.end(), document_id);
+    if (it == ids.end() || *it != document_id) {
+        throw std::out_of_range("Document not found");
+    }
+    return slots[it - ids.begin()];
+}
+
+size_t MappedSearchServer::DocumentSlotsView::size() const {
+    return ids.size();
+}
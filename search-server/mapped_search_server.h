@@ -0,0 +1,155 @@
+#pragma once
+
+#include <execution>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "collection_statistics.h"
+#include "document.h"
+#include "index_segment.h"
+#include "index_snapshot.h"
+#include "lexicon.h"
+#include "search_server.h"
+#include "tokenizer.h"
+
+// Поиск только для чтения по снимку, сохранённому SearchServer::Save.
+// Файл отображается в память, и запросы читают словарь, списки вхождений и данные
+// документов прямо из его страниц, ничего не копируя: открытие не зависит от размера индекса,
+// а несколько процессов с одним снимком делят одну копию страниц в кеше ОС.
+// Контрольные суммы секций при открытии не проверяются.
+// Методы поиска можно вызывать из любого числа потоков
+class MappedSearchServer {
+public:
+    // Бросит std::runtime_error, если файл не отображается или это не снимок индекса этой версии
+    explicit MappedSearchServer(const std::string &path);
+
+    template<typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(const std::string_view &raw_query,
+                                           DocumentPredicate document_predicate,
+                                           size_t top_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    template<typename DocumentPredicate, typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy &&policy, const std::string_view &raw_query,
+                                           DocumentPredicate document_predicate,
+                                           size_t top_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    template<typename ExecutionPolicy>
+    std::vector<Document>
+    FindTopDocuments(ExecutionPolicy &&policy, const std::string_view &raw_query, DocumentStatus status,
+                     size_t top_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(const std::string_view &raw_query, DocumentStatus status,
+                                           size_t top_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    template<typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy &&policy, const std::string_view &raw_query) const;
+
+    std::vector<Document> FindTopDocuments(const std::string_view &raw_query) const;
+
+    int GetDocumentCount() const;
+
+    // Общие слова и статусы документов по ID. Бросит std::out_of_range, если документа нет
+    std::tuple<std::vector<std::string_view>, DocumentStatus>
+    MatchDocument(const std::string_view raw_query, int document_id) const;
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus>
+    MatchDocument(const std::execution::sequenced_policy &,
+                  std::string_view raw_query, int document_id) const;
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus>
+    MatchDocument(const std::execution::parallel_policy &,
+                  std::string_view raw_query, int document_id) const;
+
+private:
+    struct DocumentData {
+        int id;
+        int rating;
+        DocumentStatus status;
+        bool is_removed;
+    };
+
+    // Статистика слов: документные частоты снимка и их логарифмы
+    class TermStatisticsView {
+    public:
+        TermStatistics operator[](TermId term_id) const;
+
+        SnapshotArray<int> document_freqs;
+        SnapshotArray<double> log_document_freqs;
+    };
+
+    // Данные документов по внутренним номерам
+    class DocumentsView {
+    public:
+        DocumentData operator[](int slot) const;
+
+        size_t size() const;
+
+        SnapshotArray<int> ids;
+        SnapshotArray<int> ratings;
+        SnapshotArray<int> statuses;
+        SnapshotArray<uint8_t> removed;
+    };
+
+    // Номера живых документов по ID: двоичный поиск по ID в порядке возрастания
+    class DocumentSlotsView {
+    public:
+        // Бросит std::out_of_range, если документа нет
+        int at(int document_id) const;
+
+        size_t size() const;
+
+        SnapshotArray<int> ids;
+        SnapshotArray<int> slots;
+    };
+
+    // Версия индекса в том виде, в котором её читают шаблоны поиска SearchServer
+    struct MappedVersion {
+        MappedLexicon lexicon;
+        std::vector<std::shared_ptr<const MappedIndexSegment>> segments;
+        TermStatisticsView term_statistics;
+        CollectionStatistics collection_statistics;
+        DocumentsView documents;
+        DocumentSlotsView document_slots;
+    };
+
+    MappedSnapshotFile file_;
+    std::unique_ptr<const Tokenizer> tokenizer_;
+    MappedVersion version_;
+};
+
+template<typename DocumentPredicate, typename ExecutionPolicy>
+std::vector<Document> MappedSearchServer::FindTopDocuments(ExecutionPolicy &&policy,
+                                                           const std::string_view &raw_query,
+                                                           DocumentPredicate document_predicate,
+                                                           size_t top_count) const {
+    const auto query = SearchServer::ParseQuery(*tokenizer_, version_, raw_query);
+    return SearchServer::FindTopDocuments(policy, version_, query, document_predicate, top_count);
+}
+
+template<typename DocumentPredicate>
+std::vector<Document>
+MappedSearchServer::FindTopDocuments(const std::string_view &raw_query, DocumentPredicate document_predicate,
+                                     size_t top_count) const {
+    return FindTopDocuments(std::execution::seq, raw_query, document_predicate, top_count);
+}
+
+template<typename ExecutionPolicy>
+std::vector<Document>
+MappedSearchServer::FindTopDocuments(ExecutionPolicy &&policy, const std::string_view &raw_query,
+                                     DocumentStatus status, size_t top_count) const {
+    return FindTopDocuments(policy, raw_query,
+                            [status](int, DocumentStatus new_status, int) {
+                                return new_status == status;
+                            },
+                            top_count);
+}
+
+template<typename ExecutionPolicy>
+std::vector<Document> MappedSearchServer::FindTopDocuments(ExecutionPolicy &&policy,
+                                                           const std::string_view &raw_query) const {
+    return FindTopDocuments(policy, raw_query, DocumentStatus::ACTUAL);
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "posting_list.h"
+#include "top_documents.h"
+
+// Плюс-слово запроса, подготовленное к отбору документов
+struct ScoredTerm {
+    PostingList::Cursor cursor;
+    double inverse_document_freq = 0.0;
+    double max_score = 0.0; // Верхняя граница вклада слова в релевантность документа
+};
+
+// Отбор лучших документов методом MaxScore: документы обходятся по возрастанию ID,
+// для каждого сразу считается полная релевантность.
+// Слова упорядочиваются по верхней границе вклада. Слова, суммарный вклад которых
+// ниже порога top_documents, не порождают кандидатов, а только досчитывают релевантность
+// кандидатов остальных слов, поэтому документы, которые не могут попасть в выдачу,
+// пропускаются. Кроме того, для каждого кандидата проверяется граница по блокам
+// списков, что позволяет пропускать целые блоки. Результат совпадает с полным перебором.
+// document_filter(document_id) вернёт рейтинг документа
+// или пустое значение, если документ не подходит под условия поиска
+template<typename DocumentFilter>
+void CollectTopDocuments(std::vector<ScoredTerm> &terms,
+                         std::vector<PostingList::Cursor> &minus_cursors,
+                         DocumentFilter document_filter,
+                         TopDocuments &top_documents) {
+    std::sort(terms.begin(), terms.end(), [](const ScoredTerm &lhs, const ScoredTerm &rhs) {
+        return lhs.max_score < rhs.max_score;
+    });
+    // max_score_prefix[i] - верхняя граница суммарного вклада слов [0, i]
+    std::vector<double> max_score_prefix(terms.size());
+    double max_score_sum = 0.0;
+    for (size_t i = 0; i < terms.size(); ++i) {
+        max_score_sum += terms[i].max_score;
+        max_score_prefix[i] = max_score_sum;
+    }
+
+    // Слова [0, first_essential) кандидатов не порождают
+    size_t first_essential = 0;
+    double threshold = top_documents.GetThreshold();
+    // Граница релевантности по блокам для документов с ID до block_end включительно
+    double block_max_score = 0.0;
+    int block_end = -1;
+    while (true) {
+        while (first_essential < terms.size() && max_score_prefix[first_essential] < threshold) {
+            ++first_essential;
+        }
+        if (first_essential == terms.size()) {
+            break;
+        }
+
+        std::optional<int> candidate;
+        for (size_t i = first_essential; i < terms.size(); ++i) {
+            const auto &cursor = terms[i].cursor;
+            if (!cursor.IsEnd() && (!candidate || cursor.GetDocumentId() < *candidate)) {
+                candidate = cursor.GetDocumentId();
+            }
+        }
+        if (!candidate) {
+            break;
+        }
+        const int document_id = *candidate;
+
+        // Граница по блокам: сумма максимальных вкладов блоков, в которые попадает кандидат.
+        // Она верна для всех документов до конца самого короткого из этих блоков,
+        // поэтому пересчитывается только при выходе кандидата за этот диапазон.
+        // Если граница ниже порога, весь диапазон пропускается
+        if (document_id > block_end) {
+            block_max_score = 0.0;
+            block_end = std::numeric_limits<int>::max();
+            for (auto &term: terms) {
+                if (term.cursor.NextBlockGeq(document_id)) {
+                    block_max_score += term.cursor.GetBlockMaxTermFreq() * term.inverse_document_freq;
+                    block_end = std::min(block_end, term.cursor.GetBlockLastDocumentId());
+                }
+            }
+        }
+        if (block_max_score < threshold) {
+            if (block_end == std::numeric_limits<int>::max()) {
+                break;
+            }
+            for (size_t i = first_essential; i < terms.size(); ++i) {
+                terms[i].cursor.NextGeq(block_end + 1);
+            }
+            continue;
+        }
+
+        double relevance = 0.0;
+        for (size_t i = first_essential; i < terms.size(); ++i) {
+            auto &term = terms[i];
+            if (!term.cursor.IsEnd() && term.cursor.GetDocumentId() == document_id) {
+                relevance += term.cursor.GetTermFreq() * term.inverse_document_freq;
+                term.cursor.Next();
+            }
+        }
+
+        bool is_pruned = false;
+        for (size_t i = first_essential; i-- > 0;) {
+            if (relevance + max_score_prefix[i] < threshold) {
+                is_pruned = true;
+                break;
+            }
+            auto &term = terms[i];
+            term.cursor.NextGeq(document_id);
+            if (!term.cursor.IsEnd() && term.cursor.GetDocumentId() == document_id) {
+                relevance += term.cursor.GetTermFreq() * term.inverse_document_freq;
+            }
+        }
+        if (is_pruned) {
+            continue;
+        }
+
+        const bool has_minus_word = std::any_of(
+                minus_cursors.begin(), minus_cursors.end(),
+                [document_id](PostingList::Cursor &cursor) {
+                    cursor.NextGeq(document_id);
+                    return !cursor.IsEnd() && cursor.GetDocumentId() == document_id;
+                });
+        if (has_minus_word) {
+            continue;
+        }
+
+        if (const auto rating = document_filter(document_id)) {
+            top_documents.Add({document_id, relevance, *rating});
+            threshold = top_documents.GetThreshold();
+        }
+    }
+}
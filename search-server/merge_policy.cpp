@@ -0,0 +1,62 @@
+#include "merge_policy.h"
+
+#include <stdexcept>
+
+namespace {
+
+size_t GetSegmentLevel(size_t segment_size, const MergePolicy &policy) {
+    size_t level = 0;
+    for (size_t size = policy.write_segment_size * policy.merge_factor; size <= segment_size;
+         size *= policy.merge_factor) {
+        ++level;
+    }
+    return level;
+}
+
+} // namespace
+
+void CheckMergePolicy(const MergePolicy &policy) {
+    if (policy.write_segment_size == 0 || policy.merge_factor < 2
+        || !(policy.max_removed_ratio > 0.0 && policy.max_removed_ratio <= 1.0)) {
+        throw std::invalid_argument("Invalid merge policy");
+    }
+}
+
+std::optional<std::pair<size_t, size_t>> FindSegmentsToMerge(const std::vector<size_t> &segment_sizes,
+                                                             const MergePolicy &policy) {
+    std::optional<std::pair<size_t, size_t>> result;
+    std::optional<size_t> result_level;
+    size_t run_begin = 0;
+    for (size_t i = 0; i < segment_sizes.size(); ++i) {
+        const size_t level = GetSegmentLevel(segment_sizes[i], policy);
+        if (i > 0 && level != GetSegmentLevel(segment_sizes[i - 1], policy)) {
+            run_begin = i;
+        }
+        if (i + 1 - run_begin == policy.merge_factor && (!result_level || level < *result_level)) {
+            result = std::pair{run_begin, i + 1};
+            result_level = level;
+        }
+        if (i + 1 - run_begin == policy.merge_factor) {
+            run_begin = i + 1;
+        }
+    }
+    return result;
+}
+
+std::optional<size_t> FindSegmentToCompact(const std::vector<size_t> &segment_sizes,
+                                           const std::vector<size_t> &removed_counts,
+                                           const MergePolicy &policy) {
+    std::optional<size_t> result;
+    double result_ratio = policy.max_removed_ratio;
+    for (size_t i = 0; i < segment_sizes.size(); ++i) {
+        if (segment_sizes[i] == 0) {
+            continue;
+        }
+        const double removed_ratio = static_cast<double>(removed_counts[i]) / static_cast<double>(segment_sizes[i]);
+        if (removed_ratio > result_ratio) {
+            result = i;
+            result_ratio = removed_ratio;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Правила объединения сегментов индекса.
+// Уровень сегмента - сколько раз его размер можно разделить на merge_factor,
+// не опустившись ниже write_segment_size. Объединяются merge_factor подряд идущих
+// сегментов одного уровня, поэтому каждый документ переписывается O(log N) раз
+struct MergePolicy {
+    size_t write_segment_size = 4096; // Документов в изменяемом сегменте, после которых он замораживается
+    size_t merge_factor = 4; // Сколько сегментов одного уровня объединяются в один
+    // Доля удалённых документов, которые ещё остались в списках сегмента, после которой
+    // сегмент переписывается без них, даже если сливать его не с чем
+    double max_removed_ratio = 0.25;
+};
+
+// Бросит std::invalid_argument, если правила некорректны
+void CheckMergePolicy(const MergePolicy &policy);
+
+// Выберет для слияния сегменты [first, last) по их размерам в порядке номеров документов.
+// Из подходящих групп выбирается группа самого низкого уровня.
+// Вернёт пустое значение, если сливать нечего
+std::optional<std::pair<size_t, size_t>> FindSegmentsToMerge(const std::vector<size_t> &segment_sizes,
+                                                             const MergePolicy &policy);
+
+// Выберет неизменяемый сегмент, доля удалённых документов в котором больше max_removed_ratio.
+// removed_counts - число удалённых документов, оставшихся в списках каждого сегмента.
+// Из подходящих выбирается сегмент с наибольшей долей. Вернёт пустое значение, если таких нет
+std::optional<size_t> FindSegmentToCompact(const std::vector<size_t> &segment_sizes,
+                                           const std::vector<size_t> &removed_counts,
+                                           const MergePolicy &policy);
@@ -0,0 +1,286 @@
+#include "posting_list.h"
+
+#include <algorithm>
+#include <cassert>
+
+PostingList::Cursor::Cursor(const PostingList &postings, const double *inverse_word_counts, int first_document)
+        : Cursor(postings.GetView(), inverse_word_counts, first_document) {
+}
+
+PostingList::Cursor::Cursor(const View &postings, const double *inverse_word_counts, int first_document)
+        : postings_(postings), inverse_word_counts_(inverse_word_counts), first_document_(first_document) {
+    LoadBlock(0);
+}
+
+bool PostingList::Cursor::IsEnd() const {
+    return pos_ == size_;
+}
+
+int PostingList::Cursor::GetDocumentId() const {
+    return static_cast<int>(document_ids_[pos_]) + first_document_;
+}
+
+uint32_t PostingList::Cursor::GetTermCount() const {
+    if (!has_term_counts_) {
+        LoadTermCounts();
+    }
+    return term_counts_[pos_];
+}
+
+double PostingList::Cursor::GetTermFreq() const {
+    return GetTermCount() * inverse_word_counts_[document_ids_[pos_]];
+}
+
+void PostingList::Cursor::Next() {
+    if (++pos_ == size_) {
+        LoadBlock(current_ + 1);
+    }
+}
+
+void PostingList::Cursor::NextGeq(int document_id) {
+    if (IsEnd() || GetDocumentId() >= document_id) {
+        return;
+    }
+    if (!NextBlockGeq(document_id)) {
+        LoadBlock(postings_.GetBlockCount());
+        return;
+    }
+    if (block_ != current_) {
+        LoadBlock(block_);
+    }
+    // Искомый документ - в пределах распакованного блока
+    pos_ = std::lower_bound(document_ids_ + pos_, document_ids_ + size_,
+                            static_cast<uint32_t>(document_id - first_document_)) - document_ids_;
+}
+
+bool PostingList::Cursor::NextBlockGeq(int document_id) {
+    document_id -= first_document_;
+    const size_t block_count = postings_.GetBlockCount();
+    if (block_ < block_count && postings_.GetBlockLastDocumentId(block_) < document_id) {
+        const auto &blocks = postings_.blocks_;
+        const auto first = blocks.begin() + static_cast<std::ptrdiff_t>(std::min(block_ + 1, blocks.size()));
+        block_ = std::partition_point(first, blocks.end(), [document_id](const Block &block) {
+            return block.last_document < document_id;
+        }) - blocks.begin();
+        if (block_ == blocks.size() && postings_.GetBlockLastDocumentId(block_count - 1) < document_id) {
+            block_ = block_count;
+        }
+    }
+    return block_ < block_count;
+}
+
+int PostingList::Cursor::GetBlockLastDocumentId() const {
+    return postings_.GetBlockLastDocumentId(block_) + first_document_;
+}
+
+double PostingList::Cursor::GetBlockMaxTermFreq() const {
+    return postings_.GetBlockMaxTermFreq(block_);
+}
+
+void PostingList::Cursor::LoadBlock(size_t block) {
+    current_ = block;
+    block_ = std::max(block_, block);
+    pos_ = 0;
+    const auto &tail_document_ids = postings_.tail_document_ids_;
+    has_term_counts_ = false;
+    if (block < postings_.blocks_.size()) {
+        size_ = postings_.DecodeDocumentIds(block, document_ids_);
+    } else if (block == postings_.blocks_.size()) {
+        size_ = tail_document_ids.size();
+        std::copy(tail_document_ids.begin(), tail_document_ids.end(), document_ids_);
+    } else {
+        size_ = 0;
+    }
+}
+
+void PostingList::Cursor::LoadTermCounts() const {
+    if (current_ < postings_.blocks_.size()) {
+        postings_.DecodeTermCounts(current_, term_counts_);
+    } else {
+        const auto &tail_term_counts = postings_.tail_term_counts_;
+        std::copy(tail_term_counts.begin(), tail_term_counts.end(), term_counts_);
+    }
+    has_term_counts_ = true;
+}
+
+void PostingList::Add(int document_id, uint32_t term_count, double term_freq) {
+    // Сегмент нумерует документы по порядку добавления, поэтому список только дописывается
+    assert(tail_document_ids_.empty() ? blocks_.empty() || blocks_.back().last_document < document_id
+                                      : tail_document_ids_.back() < document_id);
+    ++size_;
+    max_term_freq_ = std::max(max_term_freq_, term_freq);
+    tail_document_ids_.push_back(document_id);
+    tail_term_counts_.push_back(term_count);
+    tail_max_term_freq_ = std::max(tail_max_term_freq_, term_freq);
+    if (tail_document_ids_.size() == BLOCK_SIZE) {
+        SealTail();
+    }
+}
+
+bool PostingList::Contains(int document_id) const {
+    return GetView().Contains(document_id);
+}
+
+void PostingList::Save(SnapshotWriter &writer) const {
+    // В Block нет байтов выравнивания, поэтому блоки пишутся одним куском
+    static_assert(sizeof(Block) == 24);
+    writer.WriteArray(blocks_);
+    writer.WriteArray(packed_);
+    writer.WriteArray(tail_document_ids_);
+    writer.WriteArray(tail_term_counts_);
+    writer.Write(tail_max_term_freq_);
+    writer.Write(max_term_freq_);
+    writer.Write<uint64_t>(size_);
+}
+
+PostingList PostingList::Load(SnapshotReader &reader) {
+    const View view = View::Load(reader);
+    // Отображённый снимок читается без проверок, а загружаемый проверяется целиком
+    size_t size = view.tail_document_ids_.size();
+    for (const Block &block : view.blocks_) {
+        if (block.size > BLOCK_SIZE || block.document_bits > 32 || block.count_bits > 32
+            || block.offset + GetPackedWordCount(block.document_bits) + GetPackedWordCount(block.count_bits)
+               > view.packed_.size()) {
+            ThrowSnapshotCorrupted();
+        }
+        size += block.size;
+    }
+    if (view.tail_term_counts_.size() != view.tail_document_ids_.size() || size != view.size_) {
+        ThrowSnapshotCorrupted();
+    }
+    PostingList postings;
+    postings.blocks_.assign(view.blocks_.begin(), view.blocks_.end());
+    postings.packed_.assign(view.packed_.begin(), view.packed_.end());
+    postings.tail_document_ids_.assign(view.tail_document_ids_.begin(), view.tail_document_ids_.end());
+    postings.tail_term_counts_.assign(view.tail_term_counts_.begin(), view.tail_term_counts_.end());
+    postings.tail_max_term_freq_ = view.tail_max_term_freq_;
+    postings.max_term_freq_ = view.max_term_freq_;
+    postings.size_ = view.size_;
+    return postings;
+}
+
+void PostingList::Compact() {
+    if (!tail_document_ids_.empty()) {
+        SealTail();
+    }
+    blocks_.shrink_to_fit();
+    packed_.shrink_to_fit();
+    tail_document_ids_.shrink_to_fit();
+    tail_term_counts_.shrink_to_fit();
+}
+
+size_t PostingList::size() const {
+    return size_;
+}
+
+bool PostingList::empty() const {
+    return size_ == 0;
+}
+
+double PostingList::GetMaxTermFreq() const {
+    return max_term_freq_;
+}
+
+PostingList::View PostingList::GetView() const {
+    View view;
+    view.blocks_ = {blocks_.data(), blocks_.size()};
+    view.packed_ = {packed_.data(), packed_.size()};
+    view.tail_document_ids_ = {tail_document_ids_.data(), tail_document_ids_.size()};
+    view.tail_term_counts_ = {tail_term_counts_.data(), tail_term_counts_.size()};
+    view.tail_max_term_freq_ = tail_max_term_freq_;
+    view.max_term_freq_ = max_term_freq_;
+    view.size_ = size_;
+    return view;
+}
+
+size_t PostingList::View::size() const {
+    return size_;
+}
+
+bool PostingList::View::empty() const {
+    return size_ == 0;
+}
+
+double PostingList::View::GetMaxTermFreq() const {
+    return max_term_freq_;
+}
+
+bool PostingList::View::Contains(int document_id) const {
+    const size_t block = FindBlock(document_id);
+    if (block == blocks_.size()) {
+        return std::binary_search(tail_document_ids_.begin(), tail_document_ids_.end(), document_id);
+    }
+    uint32_t document_ids[BLOCK_SIZE];
+    const size_t size = DecodeDocumentIds(block, document_ids);
+    return std::binary_search(document_ids, document_ids + size, static_cast<uint32_t>(document_id));
+}
+
+PostingList::View PostingList::View::Load(SnapshotReader &reader) {
+    View view;
+    view.blocks_ = reader.ReadArrayView<Block>();
+    view.packed_ = reader.ReadArrayView<uint32_t>();
+    view.tail_document_ids_ = reader.ReadArrayView<int>();
+    view.tail_term_counts_ = reader.ReadArrayView<uint32_t>();
+    view.tail_max_term_freq_ = reader.Read<double>();
+    view.max_term_freq_ = reader.Read<double>();
+    view.size_ = reader.Read<uint64_t>();
+    return view;
+}
+
+size_t PostingList::View::GetBlockCount() const {
+    return blocks_.size() + (tail_document_ids_.empty() ? 0 : 1);
+}
+
+int PostingList::View::GetBlockLastDocumentId(size_t block) const {
+    return block < blocks_.size() ? blocks_[block].last_document : tail_document_ids_.back();
+}
+
+double PostingList::View::GetBlockMaxTermFreq(size_t block) const {
+    return block < blocks_.size() ? blocks_[block].max_term_freq : tail_max_term_freq_;
+}
+
+size_t PostingList::View::FindBlock(int document_id) const {
+    return static_cast<size_t>(std::partition_point(blocks_.begin(), blocks_.end(), [document_id](const Block &block) {
+        return block.last_document < document_id;
+    }) - blocks_.begin());
+}
+
+size_t PostingList::View::DecodeDocumentIds(size_t block, uint32_t *document_ids) const {
+    const Block &data = blocks_[block];
+    UnpackBlock(packed_.data() + data.offset, data.document_bits, document_ids);
+    DecodeDeltas(document_ids, static_cast<uint32_t>(data.base_document));
+    return data.size;
+}
+
+void PostingList::View::DecodeTermCounts(size_t block, uint32_t *term_counts) const {
+    const Block &data = blocks_[block];
+    UnpackBlock(packed_.data() + data.offset + GetPackedWordCount(data.document_bits), data.count_bits, term_counts);
+}
+
+void PostingList::SealTail() {
+    uint32_t values[BLOCK_SIZE];
+    uint32_t counts[BLOCK_SIZE];
+    uint32_t deltas[BLOCK_SIZE];
+    const size_t size = tail_document_ids_.size();
+    const uint32_t base = blocks_.empty() ? 0 : static_cast<uint32_t>(blocks_.back().last_document);
+    // Неполный блок дополняется последним документом с нулевым числом вхождений
+    const auto last = static_cast<uint32_t>(tail_document_ids_.back());
+    std::fill(std::copy(tail_document_ids_.begin(), tail_document_ids_.end(), values), values + BLOCK_SIZE, last);
+    std::fill(std::copy(tail_term_counts_.begin(), tail_term_counts_.end(), counts), counts + BLOCK_SIZE, 0);
+    EncodeDeltas(values, base, deltas);
+    const uint32_t document_bits = GetRequiredBits(deltas);
+    const uint32_t count_bits = GetRequiredBits(counts);
+
+    const auto offset = static_cast<uint32_t>(packed_.size());
+    packed_.insert(offset, GetPackedWordCount(document_bits) + GetPackedWordCount(count_bits), 0);
+    // Упакованные слова лежат за границей, которую видят копии списка, поэтому указатель берётся после вставки
+    uint32_t *packed = packed_.GetMutableData(offset);
+    PackBlock(deltas, document_bits, packed);
+    PackBlock(counts, count_bits, packed + GetPackedWordCount(document_bits));
+    blocks_.push_back({static_cast<int>(base), static_cast<int>(last), offset, static_cast<uint16_t>(size),
+                       static_cast<uint8_t>(document_bits), static_cast<uint8_t>(count_bits), tail_max_term_freq_});
+
+    tail_document_ids_.clear();
+    tail_term_counts_.clear();
+    tail_max_term_freq_ = 0.0;
+}
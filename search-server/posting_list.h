@@ -0,0 +1,171 @@
+#pragma once
+
+#include "bit_packing.h"
+#include "index_snapshot.h"
+#include "shared_vector.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Список вхождений слова в документы.
+// Для каждого документа хранится число вхождений слова, частота получается
+// умножением на обратную длину документа, которую хранит сегмент индекса.
+// Список разбит на блоки до BLOCK_SIZE документов. Полные блоки сжаты: разности
+// номеров документов и числа вхождений упакованы с минимальной разрядностью (bit_packing.h).
+// Последние документы, ещё не набравшие блок, хранятся несжатыми.
+// Для каждого блока хранятся номер последнего документа (указатель пропуска)
+// и верхняя граница частоты слова в блоке.
+class PostingList {
+private:
+    struct Block {
+        int base_document; // От него считаются первые разности блока
+        int last_document;
+        uint32_t offset; // Начало блока в packed_
+        uint16_t size;
+        uint8_t document_bits;
+        uint8_t count_bits;
+        double max_term_freq;
+    };
+
+public:
+    static constexpr size_t BLOCK_SIZE = PACKED_BLOCK_SIZE;
+
+    // Список только для чтения поверх чужих массивов: данных PostingList или снимка индекса
+    // в памяти. Копируется дёшево и действителен, пока живут массивы
+    class View {
+    public:
+        size_t size() const;
+
+        bool empty() const;
+
+        double GetMaxTermFreq() const;
+
+        bool Contains(int document_id) const;
+
+        // Прочитает список, записанный PostingList::Save, не копируя и не проверяя его массивы.
+        // Данные снимка должны быть выровнены по границе 8 байт
+        static View Load(SnapshotReader &reader);
+
+    private:
+        friend class PostingList;
+
+        SnapshotArray<Block> blocks_;
+        SnapshotArray<uint32_t> packed_;
+        SnapshotArray<int> tail_document_ids_;
+        SnapshotArray<uint32_t> tail_term_counts_;
+        double tail_max_term_freq_ = 0.0;
+        double max_term_freq_ = 0.0;
+        size_t size_ = 0;
+
+        size_t GetBlockCount() const;
+
+        int GetBlockLastDocumentId(size_t block) const;
+
+        double GetBlockMaxTermFreq(size_t block) const;
+
+        // Найдёт блок, который может содержать документ. Вернёт blocks_.size() для хвоста
+        size_t FindBlock(int document_id) const;
+
+        // Распакует номера документов сжатого блока, вернёт их количество
+        size_t DecodeDocumentIds(size_t block, uint32_t *document_ids) const;
+
+        void DecodeTermCounts(size_t block, uint32_t *term_counts) const;
+    };
+
+    // Последовательный обход списка по возрастанию номеров документов.
+    // Номера документов текущего блока распаковываются в буфер курсора целиком,
+    // числа вхождений - при первом обращении к ним
+    class Cursor {
+    public:
+        Cursor() = default;
+
+        // Номера документов в списке отсчитываются от first_document, курсор возвращает
+        // и принимает полные номера. inverse_word_counts - обратные длины документов
+        // по номерам в списке, nullptr, если частоты слова не нужны
+        explicit Cursor(const PostingList &postings, const double *inverse_word_counts = nullptr,
+                        int first_document = 0);
+
+        explicit Cursor(const View &postings, const double *inverse_word_counts = nullptr,
+                        int first_document = 0);
+
+        bool IsEnd() const;
+
+        int GetDocumentId() const;
+
+        uint32_t GetTermCount() const;
+
+        double GetTermFreq() const;
+
+        void Next();
+
+        // Перейдёт к первому документу с ID не меньше document_id
+        void NextGeq(int document_id);
+
+        // Перейдёт к блоку, который может содержать document_id, не меняя позицию в списке.
+        // Вернёт false, если в списке нет документов с ID не меньше document_id.
+        // Блоки не возвращаются назад: следующие NextGeq и NextBlockGeq получают ID не меньше document_id
+        bool NextBlockGeq(int document_id);
+
+        // ID последнего документа и максимальная частота слова в текущем блоке
+        int GetBlockLastDocumentId() const;
+
+        double GetBlockMaxTermFreq() const;
+
+    private:
+        View postings_;
+        const double *inverse_word_counts_ = nullptr;
+        int first_document_ = 0;
+        size_t current_ = 0; // Распакованный блок
+        size_t block_ = 0; // Блок для оценок, не раньше распакованного
+        size_t pos_ = 0;
+        size_t size_ = 0;
+        uint32_t document_ids_[BLOCK_SIZE] = {};
+        mutable uint32_t term_counts_[BLOCK_SIZE] = {};
+        mutable bool has_term_counts_ = false;
+
+        void LoadBlock(size_t block);
+
+        void LoadTermCounts() const;
+    };
+
+    // Допишет документ с номером больше номеров документов списка.
+    // term_freq - частота слова в документе, по ней обновляются границы блоков
+    void Add(int document_id, uint32_t term_count, double term_freq);
+
+    bool Contains(int document_id) const;
+
+    // Сожмёт несжатый хвост списка в блок и освободит лишнюю память.
+    // Вызывается, когда список больше не будет пополняться
+    void Compact();
+
+    size_t size() const;
+
+    bool empty() const;
+
+    // Верхняя граница частоты слова в документах списка
+    double GetMaxTermFreq() const;
+
+    // Действителен до следующего изменения списка
+    View GetView() const;
+
+    // Запишет список в секцию снимка индекса как есть, без пересжатия
+    void Save(SnapshotWriter &writer) const;
+
+    // Прочитает список, записанный Save. Бросит std::runtime_error, если данные повреждены
+    static PostingList Load(SnapshotReader &reader);
+
+private:
+    // Копия списка делит массивы с оригиналом, поэтому копирование не зависит от длины списка,
+    // а документы, дописанные в конец оригинала, копия не видит
+    SharedVector<Block> blocks_;
+    SharedVector<uint32_t> packed_;
+    SharedVector<int> tail_document_ids_;
+    SharedVector<uint32_t> tail_term_counts_;
+    double tail_max_term_freq_ = 0.0;
+    double max_term_freq_ = 0.0;
+    size_t size_ = 0;
+
+    // Сожмёт несжатый хвост в новый блок
+    void SealTail();
+};
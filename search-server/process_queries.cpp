@@ -1,20 +1,156 @@
 #include "process_queries.h"
 
-std::vector<std::vector<Document>> ProcessQueries(const SearchServer &search_server,
-                                                  const std::vector<std::string> &queries) {
+#include <numeric>
+
+namespace {
+
+// Порций на поток: с запасом, чтобы освободившимся потокам было что перехватить
+constexpr size_t CHUNKS_PER_WORKER = 4;
+
+struct QueryChunk {
+    size_t first;
+    size_t last;
+    size_t cost;
+};
+
+// Разобьёт запросы на подряд идущие порции трудоёмкостью не меньше target_cost, кроме последней
+std::vector<QueryChunk> SplitIntoChunks(const std::vector<size_t> &costs, size_t target_cost) {
+    std::vector<QueryChunk> chunks;
+    QueryChunk chunk{0, 0, 0};
+    for (size_t i = 0; i < costs.size(); ++i) {
+        // Тяжёлый запрос не присоединяется к накопленной порции
+        if (costs[i] >= target_cost && chunk.first != i) {
+            chunks.push_back(chunk);
+            chunk = {i, i, 0};
+        }
+        chunk.last = i + 1;
+        chunk.cost += costs[i];
+        if (chunk.cost >= target_cost) {
+            chunks.push_back(chunk);
+            chunk = {i + 1, i + 1, 0};
+        }
+    }
+    if (chunk.first != chunk.last) {
+        chunks.push_back(chunk);
+    }
+    return chunks;
+}
+
+// Выполнит запросы пакетом на потоках pool: run_query(пакет, номер запроса) вызывается
+// из потоков пула для каждого запроса
+template<typename QueryRunner>
+void RunQueries(ThreadPool &pool, const SearchServer &search_server, const std::vector<std::string> &queries,
+                QueryRunner run_query) {
+    // Слова всех запросов разбираются и находятся в индексе один раз на пакет
+    const SearchServer::QueryBatch batch(search_server, queries);
+    std::vector<size_t> costs;
+    costs.reserve(queries.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        costs.push_back(batch.GetQueryCost(i));
+    }
+    const size_t total_cost = std::accumulate(costs.begin(), costs.end(), size_t{0});
+    const size_t target_cost = std::max<size_t>(1, total_cost / (pool.GetWorkerCount() * CHUNKS_PER_WORKER));
+    auto chunks = SplitIntoChunks(costs, target_cost);
+    std::stable_sort(chunks.begin(), chunks.end(), [](const QueryChunk &lhs, const QueryChunk &rhs) {
+        return lhs.cost > rhs.cost;
+    });
+
+    std::vector<std::function<void()>> tasks;
+    tasks.reserve(chunks.size());
+    for (const auto &chunk : chunks) {
+        tasks.emplace_back([&batch, &run_query, chunk] {
+            for (size_t i = chunk.first; i < chunk.last; ++i) {
+                run_query(batch, i);
+            }
+        });
+    }
+    pool.Run(std::move(tasks));
+}
+
+} // namespace
+
+std::vector<std::vector<Document>> ProcessQueriesInPool(ThreadPool &pool, const SearchServer &search_server,
+                                                        const std::vector<std::string> &queries) {
     std::vector<std::vector<Document>> result(queries.size());
-    std::transform(std::execution::par, queries.begin(), queries.end(), result.begin(),
-                   [&search_server](const std::string query) {
-                       return search_server.FindTopDocuments(query);
-                   });
+    RunQueries(pool, search_server, queries, [&result](const SearchServer::QueryBatch &batch, size_t query) {
+        result[query] = batch.FindTopDocuments(query);
+    });
     return result;
 }
 
-std::list<Document> ProcessQueriesJoined(const SearchServer& search_server,
-                                         const std::vector<std::string>& queries) {
-    std::list<Document> result;
-    for (auto& documents : ProcessQueries(search_server, queries)) {
-        result.insert(result.end(), std::make_move_iterator(documents.begin()), std::make_move_iterator(documents.end()));
+std::vector<std::vector<Document>> ProcessQueries(const SearchServer &search_server,
+                                                  const std::vector<std::string> &queries) {
+    return ProcessQueriesInPool(GetQueryThreadPool(), search_server, queries);
+}
+
+JoinedDocuments::JoinedDocuments(std::vector<Document> documents, std::vector<size_t> offsets)
+        : documents_(std::move(documents)), offsets_(std::move(offsets)) {
+}
+
+JoinedDocuments::Iterator JoinedDocuments::begin() const {
+    return documents_.begin();
+}
+
+JoinedDocuments::Iterator JoinedDocuments::end() const {
+    return documents_.end();
+}
+
+size_t JoinedDocuments::size() const {
+    return documents_.size();
+}
+
+bool JoinedDocuments::empty() const {
+    return documents_.empty();
+}
+
+const Document &JoinedDocuments::operator[](size_t index) const {
+    return documents_[index];
+}
+
+size_t JoinedDocuments::GetQueryCount() const {
+    return offsets_.size() - 1;
+}
+
+IteratorRange<JoinedDocuments::Iterator> JoinedDocuments::GetQueryDocuments(size_t query) const {
+    return {documents_.begin() + static_cast<std::ptrdiff_t>(offsets_[query]),
+            documents_.begin() + static_cast<std::ptrdiff_t>(offsets_[query + 1])};
+}
+
+JoinedDocuments ProcessQueriesJoined(const SearchServer& search_server,
+                                     const std::vector<std::string>& queries) {
+    // Запрос возвращает не больше MAX_RESULT_DOCUMENT_COUNT документов, поэтому у каждого запроса
+    // свой участок буфера такого размера, и поток пишет лучшие документы запроса прямо в него.
+    // После выполнения участки сдвигаются вплотную
+    std::vector<Document> documents(queries.size() * MAX_RESULT_DOCUMENT_COUNT);
+    std::vector<size_t> counts(queries.size());
+    RunQueries(GetQueryThreadPool(), search_server, queries,
+               [&documents, &counts](const SearchServer::QueryBatch &batch, size_t query) {
+                   counts[query] = batch.FindTopDocuments(query, documents.data() + query * MAX_RESULT_DOCUMENT_COUNT);
+               });
+
+    std::vector<size_t> offsets;
+    offsets.reserve(queries.size() + 1);
+    offsets.push_back(0);
+    for (size_t query = 0; query < queries.size(); ++query) {
+        const size_t first = query * MAX_RESULT_DOCUMENT_COUNT;
+        if (first != offsets.back()) {
+            std::copy_n(documents.begin() + static_cast<std::ptrdiff_t>(first), counts[query],
+                        documents.begin() + static_cast<std::ptrdiff_t>(offsets.back()));
+        }
+        offsets.push_back(offsets.back() + counts[query]);
     }
-    return result;
-}
\ No newline at end of file
+    documents.resize(offsets.back());
+    return {std::move(documents), std::move(offsets)};
+}
+
+void ProcessQueriesStreamed(const SearchServer& search_server,
+                            const std::vector<std::string>& queries,
+                            const std::function<void(size_t, std::vector<Document>&&)>& consumer) {
+    std::mutex consumer_mutex;
+    RunQueries(GetQueryThreadPool(), search_server, queries,
+               [&consumer, &consumer_mutex](const SearchServer::QueryBatch &batch, size_t query) {
+                   auto documents = batch.FindTopDocuments(query);
+                   std::lock_guard guard(consumer_mutex);
+                   consumer(query, std::move(documents));
+               });
+}
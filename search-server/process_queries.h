@@ -2,15 +2,81 @@
 
 #include <algorithm>
 #include <execution>
-#include <list>
+#include <functional>
 #include <iterator>
+#include <mutex>
+#include <vector>
 
+#include "paginator.h"
 #include "search_server.h"
+#include "thread_pool.h"
 
+// Выполнит запросы пакетом SearchServer::QueryBatch на потоках pool. Запросы группируются
+// в подряд идущие порции примерно равной оценённой трудоёмкости (QueryBatch::GetQueryCost),
+// тяжёлый запрос - отдельная порция.
+// Порции раздаются от самых трудоёмких, поэтому тяжёлые запросы не остаются на конец пакета
+std::vector<std::vector<Document>> ProcessQueriesInPool(
+        ThreadPool &pool,
+        const SearchServer& search_server,
+        const std::vector<std::string>& queries);
+
+// Выполнит запросы на общем пуле GetQueryThreadPool()
 std::vector<std::vector<Document>> ProcessQueries(
         const SearchServer& search_server,
         const std::vector<std::string>& queries);
 
-std::list<Document> ProcessQueriesJoined(
+// Результаты пакета запросов в одном непрерывном буфере: документы запросов подряд
+// в порядке запросов и начало результатов каждого запроса
+class JoinedDocuments {
+public:
+    using Iterator = std::vector<Document>::const_iterator;
+
+    JoinedDocuments() = default;
+
+    // documents - результаты запросов подряд, offsets - начала результатов запросов и конец буфера
+    JoinedDocuments(std::vector<Document> documents, std::vector<size_t> offsets);
+
+    Iterator begin() const;
+
+    Iterator end() const;
+
+    size_t size() const;
+
+    bool empty() const;
+
+    const Document &operator[](size_t index) const;
+
+    size_t GetQueryCount() const;
+
+    // Результаты запроса с номером query
+    IteratorRange<Iterator> GetQueryDocuments(size_t query) const;
+
+private:
+    std::vector<Document> documents_;
+    std::vector<size_t> offsets_{0};
+};
+
+// Потоки пула пишут результаты прямо в общий буфер, каждый запрос - в свой участок
+JoinedDocuments ProcessQueriesJoined(
+        const SearchServer& search_server,
+        const std::vector<std::string>& queries);
+
+// Передаст результаты каждого запроса consumer(номер запроса, документы), как только запрос выполнен.
+// consumer вызывается из потоков пула, но вызовы не пересекаются во времени.
+// Результаты приходят в порядке готовности, а не в порядке запросов
+void ProcessQueriesStreamed(
         const SearchServer& search_server,
-        const std::vector<std::string>& queries);
\ No newline at end of file
+        const std::vector<std::string>& queries,
+        const std::function<void(size_t, std::vector<Document>&&)>& consumer);
+
+// Запишет документы всех запросов в out в порядке готовности запросов.
+// Документы одного запроса идут подряд. Вернёт итератор за последним записанным документом
+template<typename OutputIterator>
+OutputIterator ProcessQueriesJoined(const SearchServer& search_server,
+                                    const std::vector<std::string>& queries,
+                                    OutputIterator out) {
+    ProcessQueriesStreamed(search_server, queries, [&out](size_t, std::vector<Document>&& documents) {
+        out = std::move(documents.begin(), documents.end(), out);
+    });
+    return out;
+}
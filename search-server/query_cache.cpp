@@ -0,0 +1,98 @@
+#include "query_cache.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+void CheckQueryCacheOptions(const QueryCacheOptions &options) {
+    if (options.shard_count == 0) {
+        throw std::invalid_argument("Invalid query cache options");
+    }
+}
+
+bool QueryCacheKey::operator==(const QueryCacheKey &other) const {
+    return status == other.status && top_count == other.top_count
+           && plus_words == other.plus_words && minus_words == other.minus_words;
+}
+
+size_t QueryCacheKeyHasher::operator()(const QueryCacheKey &key) const {
+    uint64_t hash = static_cast<uint64_t>(key.status) * 0x9E3779B97F4A7C15ULL + key.top_count;
+    const auto mix = [&hash](uint64_t value) {
+        hash = (hash ^ value) * 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 32;
+    };
+    for (const TermId term_id : key.plus_words) {
+        mix(term_id);
+    }
+    // Значение, которого не бывает среди ID, отделяет минус-слова: "a -b" и "a b" различаются
+    mix(~uint64_t{0});
+    for (const TermId term_id : key.minus_words) {
+        mix(term_id);
+    }
+    return static_cast<size_t>(hash);
+}
+
+double QueryCacheStatistics::GetHitRate() const {
+    const uint64_t requests = hits + misses;
+    return requests == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(requests);
+}
+
+QueryCache::QueryCache(const QueryCacheOptions &options) {
+    CheckQueryCacheOptions(options);
+    if (options.capacity == 0) {
+        throw std::invalid_argument("Query cache capacity must be positive");
+    }
+    const size_t shard_count = std::min(options.shard_count, options.capacity);
+    shards_.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+        shards_.back()->capacity = options.capacity / shard_count + (i < options.capacity % shard_count ? 1 : 0);
+    }
+}
+
+std::optional<std::vector<Document>> QueryCache::Find(const QueryCacheKey &key, uint64_t generation) {
+    auto &shard = GetShard(key);
+    {
+        std::lock_guard guard(shard.mutex);
+        const auto it = shard.index.find(key);
+        if (it != shard.index.end() && it->second->generation == generation) {
+            shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return it->second->documents;
+        }
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+}
+
+void QueryCache::Insert(QueryCacheKey key, uint64_t generation, std::vector<Document> documents) {
+    auto &shard = GetShard(key);
+    std::lock_guard guard(shard.mutex);
+    if (const auto it = shard.index.find(key); it != shard.index.end()) {
+        // Результат другого поколения заменяется, более новый результат не затирается старым
+        if (it->second->generation < generation) {
+            it->second->generation = generation;
+            it->second->documents = std::move(documents);
+        }
+        shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        return;
+    }
+    if (shard.entries.size() >= shard.capacity) {
+        shard.index.erase(shard.entries.back().key);
+        shard.entries.pop_back();
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    shard.entries.push_front({std::move(key), generation, std::move(documents)});
+    shard.index.emplace(shard.entries.front().key, shard.entries.begin());
+    size_.fetch_add(1, std::memory_order_relaxed);
+}
+
+QueryCacheStatistics QueryCache::GetStatistics() const {
+    return {hits_.load(std::memory_order_relaxed), misses_.load(std::memory_order_relaxed),
+            evictions_.load(std::memory_order_relaxed), size_.load(std::memory_order_relaxed)};
+}
+
+QueryCache::Shard &QueryCache::GetShard(const QueryCacheKey &key) {
+    // Старшие биты хеша не участвуют в выборе корзины таблицы части
+    return *shards_[(QueryCacheKeyHasher{}(key) >> 48) % shards_.size()];
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "document.h"
+#include "lexicon.h"
+
+struct QueryCacheOptions {
+    size_t capacity = 0; // Наибольшее число результатов в кеше, 0 - кеш выключен в SearchServer
+    // Независимые части кеша со своими блокировками. Ёмкость делится между частями поровну,
+    // остаток достаётся первым частям. Частей не больше ёмкости
+    size_t shard_count = 16;
+};
+
+// Бросит std::invalid_argument, если параметры некорректны
+void CheckQueryCacheOptions(const QueryCacheOptions &options);
+
+// Разобранный запрос: ID плюс- и минус-слов по возрастанию без повторов,
+// статус искомых документов и число лучших документов
+struct QueryCacheKey {
+    std::vector<TermId> plus_words;
+    std::vector<TermId> minus_words;
+    DocumentStatus status;
+    size_t top_count;
+
+    bool operator==(const QueryCacheKey &other) const;
+};
+
+struct QueryCacheKeyHasher {
+    size_t operator()(const QueryCacheKey &key) const;
+};
+
+struct QueryCacheStatistics {
+    uint64_t hits = 0;
+    uint64_t misses = 0; // Включая найденные результаты устаревших поколений индекса
+    uint64_t evictions = 0;
+    size_t size = 0;
+
+    double GetHitRate() const;
+};
+
+// Кеш результатов поиска с вытеснением давно не использованных результатов.
+// Ключи распределены по частям с отдельными блокировками, поэтому потоки,
+// ищущие разные запросы, редко ждут друг друга.
+// Результат запоминается вместе с поколением индекса, по которому он найден.
+// Поколение растёт при каждом добавлении и удалении документов, и результат
+// другого поколения считается отсутствующим
+class QueryCache {
+public:
+    // Бросит std::invalid_argument, если параметры некорректны или ёмкость равна нулю
+    explicit QueryCache(const QueryCacheOptions &options);
+
+    // Вернёт результат, найденный по индексу поколения generation
+    std::optional<std::vector<Document>> Find(const QueryCacheKey &key, uint64_t generation);
+
+    void Insert(QueryCacheKey key, uint64_t generation, std::vector<Document> documents);
+
+    QueryCacheStatistics GetStatistics() const;
+
+private:
+    struct Entry {
+        QueryCacheKey key;
+        uint64_t generation;
+        std::vector<Document> documents;
+    };
+
+    struct Shard {
+        size_t capacity = 0;
+        std::mutex mutex;
+        std::list<Entry> entries; // От недавно использованных к давно не использованным
+        std::unordered_map<QueryCacheKey, std::list<Entry>::iterator, QueryCacheKeyHasher> index;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<size_t> size_{0};
+
+    Shard &GetShard(const QueryCacheKey &key);
+};
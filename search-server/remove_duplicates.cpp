@@ -1,24 +1,206 @@
 #include "remove_duplicates.h"
 
+#include <algorithm>
+#include <execution>
 #include <iostream>
+#include <numeric>
+#include <stdexcept>
 
-void RemoveDuplicates(SearchServer &search_server) {
-    std::map<std::set<std::string_view>, int> word_to_document_freqs; // Множество слов и ID документа
-    std::set<int> id_delete_doc; // Множество ID дубликатов для удаления
+#include "hash_mixing.h"
+
+namespace {
+
+using WordFreqs = std::pmr::map<TermId, double>;
+
+// Затравки хешей слов для MinHash. Отличаются от затравок отпечатков наборов слов,
+// поэтому подписи не зависят от отпечатков
+constexpr uint64_t MIN_HASH_FIRST_SEED = 0x2545F4914F6CDD1DULL;
+constexpr uint64_t MIN_HASH_SECOND_SEED = 0x8CB92BA72F3D8DD7ULL;
+
+bool HasSameWords(const WordFreqs &lhs, const WordFreqs &rhs) {
+    return lhs.size() == rhs.size()
+           && std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](const auto &lhs_word, const auto &rhs_word) {
+               return lhs_word.first == rhs_word.first;
+           });
+}
+
+// Подписи MinHash документов подряд, по options.signature_size хешей на документ.
+// Для каждого хеша подписи - наименьшее значение хеш-функции с этим номером по словам документа
+std::vector<uint32_t> ComputeSignatures(const std::vector<const WordFreqs *> &word_freqs,
+                                        const NearDuplicateOptions &options) {
+    std::vector<uint32_t> signatures(word_freqs.size() * options.signature_size);
+    std::vector<size_t> indexes(word_freqs.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+    std::for_each(std::execution::par, indexes.begin(), indexes.end(), [&](size_t i) {
+        uint32_t *signature = signatures.data() + i * options.signature_size;
+        std::fill(signature, signature + options.signature_size, UINT32_MAX);
+        for (const auto &[term_id, term_freq] : *word_freqs[i]) {
+            // Хеш-функции семейства - h1 + k * h2 от двух независимых хешей слова
+            const uint64_t first_hash = MixBits(term_id + MIN_HASH_FIRST_SEED);
+            const uint64_t second_hash = MixBits(term_id ^ MIN_HASH_SECOND_SEED) | 1;
+            uint64_t hash = first_hash;
+            for (size_t k = 0; k < options.signature_size; ++k) {
+                signature[k] = std::min(signature[k], static_cast<uint32_t>(hash >> 32));
+                hash += second_hash;
+            }
+        }
+    });
+    return signatures;
+}
+
+// Пары кандидатов (документ, документ с меньшим номером) по совпавшим полосам подписей.
+// Документ сравнивается с первым документом каждой своей корзины, поэтому число пар
+// не больше числа документов на полосу даже для больших корзин
+std::vector<std::pair<uint32_t, uint32_t>> FindCandidatePairs(const std::vector<uint32_t> &signatures,
+                                                              size_t document_count,
+                                                              const NearDuplicateOptions &options) {
+    const size_t rows = options.signature_size / options.band_count;
+    std::vector<std::pair<uint64_t, uint32_t>> buckets(document_count);
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    std::vector<uint32_t> indexes(document_count);
+    std::iota(indexes.begin(), indexes.end(), 0);
+    for (size_t band = 0; band < options.band_count; ++band) {
+        std::transform(std::execution::par, indexes.begin(), indexes.end(), buckets.begin(), [&](uint32_t i) {
+            const uint32_t *row = signatures.data() + i * options.signature_size + band * rows;
+            uint64_t hash = band;
+            for (size_t r = 0; r < rows; ++r) {
+                hash = MixBits(hash ^ row[r]);
+            }
+            return std::pair{hash, i};
+        });
+        std::sort(std::execution::par, buckets.begin(), buckets.end());
+        for (size_t first = 0; first < buckets.size();) {
+            size_t last = first + 1;
+            for (; last < buckets.size() && buckets[last].first == buckets[first].first; ++last) {
+                pairs.emplace_back(buckets[last].second, buckets[first].second);
+            }
+            first = last;
+        }
+    }
+    std::sort(std::execution::par, pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+    return pairs;
+}
+
+double ComputeJaccardSimilarity(const WordFreqs &lhs, const WordFreqs &rhs) {
+    size_t common = 0;
+    for (auto lhs_it = lhs.begin(), rhs_it = rhs.begin(); lhs_it != lhs.end() && rhs_it != rhs.end();) {
+        if (lhs_it->first < rhs_it->first) {
+            ++lhs_it;
+        } else if (rhs_it->first < lhs_it->first) {
+            ++rhs_it;
+        } else {
+            ++common;
+            ++lhs_it;
+            ++rhs_it;
+        }
+    }
+    const size_t united = lhs.size() + rhs.size() - common;
+    return united == 0 ? 1.0 : static_cast<double>(common) / static_cast<double>(united);
+}
 
-    for (const int document_id: search_server) {
-        std::set<std::string_view> words; // Множество слов
-        for (auto &[doc, id_and_idf]: search_server.GetWordFrequencies(document_id)) {
-            words.insert(doc);
+} // namespace
+
+void CheckNearDuplicateOptions(const NearDuplicateOptions &options) {
+    if (!(options.min_similarity > 0.0 && options.min_similarity <= 1.0) || options.band_count == 0
+        || options.signature_size == 0 || options.signature_size % options.band_count != 0) {
+        throw std::invalid_argument("Invalid near-duplicate options");
+    }
+}
+
+std::vector<NearDuplicate> FindNearDuplicates(const SearchServer &search_server,
+                                              const NearDuplicateOptions &options) {
+    CheckNearDuplicateOptions(options);
+    // Номера документов - по возрастанию ID
+    const std::vector<int> document_ids(search_server.begin(), search_server.end());
+    std::vector<const WordFreqs *> word_freqs(document_ids.size());
+    std::transform(std::execution::par, document_ids.begin(), document_ids.end(), word_freqs.begin(),
+                   [&search_server](int document_id) {
+                       return &search_server.GetWordFrequencies(document_id);
+                   });
+
+    auto pairs = FindCandidatePairs(ComputeSignatures(word_freqs, options), document_ids.size(), options);
+    std::vector<double> similarities(pairs.size());
+    std::transform(std::execution::par, pairs.begin(), pairs.end(), similarities.begin(),
+                   [&word_freqs](const std::pair<uint32_t, uint32_t> &pair) {
+                       return ComputeJaccardSimilarity(*word_freqs[pair.first], *word_freqs[pair.second]);
+                   });
+
+    // Документы просматриваются по возрастанию ID. Документ - копия, если он похож на оставляемый
+    // кандидат, или на оригинал кандидата, который сам оказался копией
+    constexpr uint32_t KEPT = UINT32_MAX;
+    std::vector<uint32_t> originals(document_ids.size(), KEPT);
+    std::vector<NearDuplicate> result;
+    for (size_t pair = 0; pair < pairs.size();) {
+        const uint32_t document = pairs[pair].first;
+        for (; pair < pairs.size() && pairs[pair].first == document; ++pair) {
+            if (originals[document] != KEPT) {
+                continue;
+            }
+            uint32_t original = pairs[pair].second;
+            double similarity = similarities[pair];
+            if (originals[original] != KEPT) {
+                original = originals[original];
+                similarity = ComputeJaccardSimilarity(*word_freqs[document], *word_freqs[original]);
+            }
+            if (similarity >= options.min_similarity) {
+                originals[document] = original;
+                result.push_back({document_ids[document], document_ids[original], similarity});
+            }
         }
-        if (word_to_document_freqs.count(words) == 0) {
-            word_to_document_freqs[words] = document_id;
-        } else if (document_id > word_to_document_freqs[words]) {
-            id_delete_doc.insert(document_id);
+    }
+    return result;
+}
+
+void RemoveNearDuplicates(SearchServer &search_server, const NearDuplicateOptions &options) {
+    std::vector<int> duplicate_ids;
+    for (const auto &duplicate : FindNearDuplicates(search_server, options)) {
+        std::cout << "Found near-duplicate document id " << duplicate.document_id
+                  << " of document id " << duplicate.original_id << std::endl;
+        duplicate_ids.push_back(duplicate.document_id);
+    }
+    search_server.RemoveDocuments(duplicate_ids);
+}
+
+void RemoveDuplicates(SearchServer &search_server) {
+    const std::vector<int> document_ids(search_server.begin(), search_server.end());
+    std::vector<const WordFreqs *> word_freqs(document_ids.size());
+    std::vector<size_t> indexes(document_ids.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+
+    // Документы группируются сортировкой по отпечатку, внутри группы - по возрастанию ID
+    std::vector<std::pair<TermSetFingerprint, size_t>> fingerprints(document_ids.size());
+    std::transform(std::execution::par, indexes.begin(), indexes.end(), fingerprints.begin(),
+                   [&search_server, &document_ids, &word_freqs](size_t i) {
+                       word_freqs[i] = &search_server.GetWordFrequencies(document_ids[i]);
+                       return std::pair{ComputeTermSetFingerprint(*word_freqs[i]), i};
+                   });
+    std::sort(std::execution::par, fingerprints.begin(), fingerprints.end());
+
+    std::vector<int> duplicate_ids;
+    std::vector<size_t> originals; // Различные наборы слов группы, обычно один
+    for (auto group = fingerprints.begin(); group != fingerprints.end();) {
+        const auto group_end = std::find_if(group, fingerprints.end(), [group](const auto &entry) {
+            return !(entry.first == group->first);
+        });
+        originals.clear();
+        for (auto it = group; it != group_end; ++it) {
+            const auto &document_word_freqs = *word_freqs[it->second];
+            const bool is_duplicate = std::any_of(originals.begin(), originals.end(), [&](size_t original) {
+                return HasSameWords(*word_freqs[original], document_word_freqs);
+            });
+            if (is_duplicate) {
+                duplicate_ids.push_back(document_ids[it->second]);
+            } else {
+                originals.push_back(it->second);
+            }
         }
+        group = group_end;
     }
-    for (auto document: id_delete_doc) {
-        std::cout << "Found duplicate document id " << document << std::endl;
-        search_server.RemoveDocument(document);
+    std::sort(duplicate_ids.begin(), duplicate_ids.end());
+
+    for (const int document_id : duplicate_ids) {
+        std::cout << "Found duplicate document id " << document_id << std::endl;
     }
-}
\ No newline at end of file
+    search_server.RemoveDocuments(duplicate_ids);
+}
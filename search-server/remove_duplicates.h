@@ -2,4 +2,40 @@
 
 #include "search_server.h"
 
-void RemoveDuplicates(SearchServer& search_server);
\ No newline at end of file
+// Удалит документы, набор слов которых совпадает с набором слов документа с меньшим ID.
+// Для каждого документа параллельно считается 128-битный отпечаток набора слов, не зависящий
+// от порядка слов. Документы с одинаковым отпечатком сравниваются по словам, поэтому
+// совпадение отпечатков разных наборов не приводит к ошибочному удалению.
+// Дубликаты удаляются одним пакетом (SearchServer::RemoveDocuments)
+void RemoveDuplicates(SearchServer& search_server);
+
+// Параметры поиска почти одинаковых документов
+struct NearDuplicateOptions {
+    // Наименьшее сходство Жаккара наборов слов, при котором документ считается копией
+    double min_similarity = 0.8;
+    size_t signature_size = 128; // Число хешей MinHash в подписи документа
+    // Подпись делится на band_count полос по signature_size / band_count хешей.
+    // Документы - кандидаты в копии, если у них совпала хотя бы одна полоса
+    size_t band_count = 32;
+};
+
+// Бросит std::invalid_argument, если параметры некорректны
+void CheckNearDuplicateOptions(const NearDuplicateOptions &options);
+
+struct NearDuplicate {
+    int document_id;
+    int original_id; // Оставляемый документ с меньшим ID
+    double similarity;
+};
+
+// Найдёт документы, набор слов которых похож на набор слов оставляемого документа с меньшим ID
+// не меньше чем на min_similarity. Подписи MinHash считаются параллельно, кандидаты в копии
+// собираются по совпавшим полосам подписей (LSH) и проверяются точным сходством наборов слов.
+// Память - подписи документов и пары кандидатов, тексты документов не нужны.
+// Поиск вероятностный: копию с совпадением немного выше порога можно пропустить.
+// Результат упорядочен по ID документов
+std::vector<NearDuplicate> FindNearDuplicates(const SearchServer& search_server,
+                                              const NearDuplicateOptions &options = {});
+
+// Удалит документы, найденные FindNearDuplicates, одним пакетом
+void RemoveNearDuplicates(SearchServer& search_server, const NearDuplicateOptions &options = {});
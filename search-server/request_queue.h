@@ -2,13 +2,15 @@
 
 #include <string>
 #include <vector>
-#include <deque>
 
+#include "request_statistics.h"
 #include "search_server.h"
 
+// Поиск с учётом запросов за последние сутки (RequestStatisticsOptions).
+// AddFindRequest можно вызывать из любого числа потоков
 class RequestQueue {
 public:
-    explicit RequestQueue(const SearchServer &search_server);
+    explicit RequestQueue(const SearchServer &search_server, const RequestStatisticsOptions &options = {});
 
     template<typename DocumentPredicate>
     std::vector<Document> AddFindRequest(const std::string &raw_query, DocumentPredicate document_predicate);
@@ -17,30 +19,32 @@ public:
 
     std::vector<Document> AddFindRequest(const std::string &raw_query);
 
+    // Запросы окна, не нашедшие ни одного документа
     int GetNoResultRequests() const;
 
+    RequestCounts GetRequestCounts() const;
+
 private:
-    struct QueryResult {
-        bool null_result;
-    };
-    std::deque<QueryResult> requests_;
-    const static int min_in_day_ = 1440;
-    int second_ = 0;
     const SearchServer &search_server_;
+    RequestStatistics statistics_;
+
+    // Найдёт документы функцией find и запишет запрос в статистику
+    template<typename FindFunction>
+    std::vector<Document> FindAndRecord(FindFunction find);
 };
 
 template<typename DocumentPredicate>
 std::vector<Document> RequestQueue::AddFindRequest(const std::string &raw_query, DocumentPredicate document_predicate) {
-    std::vector<Document> doc = search_server_.FindTopDocuments(raw_query, document_predicate);
-    ++second_;
-    while(min_in_day_ < second_) {
-        requests_.pop_front();
-        --second_;
-    }
-    if (doc.empty()) {
-        requests_.push_back({true});
-    } else {
-        requests_.push_back({false});
-    }
-    return doc;
-}
\ No newline at end of file
+    return FindAndRecord([this, &raw_query, &document_predicate] {
+        return search_server_.FindTopDocuments(raw_query, document_predicate);
+    });
+}
+
+template<typename FindFunction>
+std::vector<Document> RequestQueue::FindAndRecord(FindFunction find) {
+    const auto start = RequestStatistics::Clock::now();
+    std::vector<Document> documents = find();
+    const auto finish = RequestStatistics::Clock::now();
+    statistics_.Record(!documents.empty(), finish - start, finish);
+    return documents;
+}
@@ -0,0 +1,109 @@
+#include "request_statistics.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint64_t MakeMask(int bits) {
+    return (uint64_t{1} << bits) - 1;
+}
+
+} // namespace
+
+void CheckRequestStatisticsOptions(const RequestStatisticsOptions &options) {
+    // Номера интервалов окна должны различаться по модулю, с которым они хранятся в счётчиках
+    if (options.interval_count == 0 || options.interval_count >= (size_t{1} << 22)
+        || options.window.count() < static_cast<int64_t>(options.interval_count)
+        || options.slow_request_duration.count() < 0) {
+        throw std::invalid_argument("Invalid request statistics options");
+    }
+}
+
+RequestStatistics::RequestStatistics(const RequestStatisticsOptions &options)
+        : options_(options) {
+    CheckRequestStatisticsOptions(options);
+    start_ = Clock::now();
+    interval_duration_ = std::chrono::duration_cast<Clock::duration>(
+            options.window / static_cast<int64_t>(options.interval_count));
+    intervals_ = std::make_unique<Interval[]>(options.interval_count);
+}
+
+void RequestStatistics::Record(bool has_result, Clock::duration duration, Clock::time_point now) {
+    const int64_t interval = GetIntervalNumber(now);
+    Sweep(interval);
+    auto &counters = intervals_[static_cast<size_t>(interval) % options_.interval_count].counters;
+    totals_[TOTAL].fetch_add(AddToCounter(counters[TOTAL], interval, 1));
+    if (!has_result) {
+        totals_[NO_RESULT].fetch_add(AddToCounter(counters[NO_RESULT], interval, 1));
+    }
+    if (duration >= options_.slow_request_duration) {
+        totals_[SLOW].fetch_add(AddToCounter(counters[SLOW], interval, 1));
+    }
+}
+
+RequestCounts RequestStatistics::GetCounts(Clock::time_point now) const {
+    Sweep(GetIntervalNumber(now));
+    const auto load = [this](Counter counter) {
+        return static_cast<uint64_t>(std::max<int64_t>(0, totals_[counter].load()));
+    };
+    return {load(TOTAL), load(NO_RESULT), load(SLOW)};
+}
+
+const RequestStatisticsOptions &RequestStatistics::GetOptions() const {
+    return options_;
+}
+
+int64_t RequestStatistics::GetIntervalNumber(Clock::time_point now) const {
+    return now <= start_ ? 0 : (now - start_) / interval_duration_;
+}
+
+void RequestStatistics::Sweep(int64_t interval) const {
+    int64_t swept = swept_interval_.load();
+    while (swept < interval) {
+        // Интервалы сбрасывает один поток - тот, кто сдвинул границу
+        if (swept_interval_.compare_exchange_weak(swept, interval)) {
+            const auto interval_count = static_cast<int64_t>(options_.interval_count);
+            const auto sweep_range = [this, interval_count](int64_t first, int64_t last) {
+                for (int64_t stale = first; stale <= last; ++stale) {
+                    auto &counters = intervals_[static_cast<size_t>(stale % interval_count)].counters;
+                    for (int counter = 0; counter < COUNTER_COUNT; ++counter) {
+                        totals_[counter].fetch_add(AddToCounter(counters[counter], stale, 0));
+                    }
+                }
+            };
+            // После простоя дольше окна номера в счётчиках могут совпасть по модулю с новыми.
+            // Поэтому сначала кольцо сбрасывается интервалами сразу за swept: они отстают от хранимых
+            // меньше чем на два окна. Пустые счётчики затем принимают номера нового окна без сравнения
+            if (interval - swept > interval_count) {
+                sweep_range(swept + 1, swept + interval_count);
+            }
+            sweep_range(std::max(swept + 1, interval - interval_count + 1), interval);
+            return;
+        }
+    }
+}
+
+int64_t RequestStatistics::AddToCounter(std::atomic<uint64_t> &counter, int64_t interval, uint64_t count) const {
+    constexpr uint64_t TAG_MASK = MakeMask(TAG_BITS);
+    constexpr uint64_t COUNT_MASK = MakeMask(COUNT_BITS);
+    const uint64_t tag = static_cast<uint64_t>(interval) & TAG_MASK;
+    // Более новый номер в счётчике может быть только у интервала того же места кольца не дальше
+    // следующего круга. Всё остальное отставание по модулю - устаревший счётчик
+    const uint64_t max_stale_lag = TAG_MASK - options_.interval_count;
+    uint64_t value = counter.load();
+    while (true) {
+        const uint64_t lag = (tag - (value >> COUNT_BITS)) & TAG_MASK;
+        const uint64_t removed = value & COUNT_MASK;
+        // Номер пустого счётчика ничего не значит и просто заменяется
+        const bool is_stale = lag != 0 && (removed == 0 || lag <= max_stale_lag);
+        if (!is_stale && count == 0) {
+            return 0;
+        }
+        // Запрос, записанный позже, чем интервал сдвинулся дальше, засчитывается новому интервалу
+        const uint64_t updated = is_stale ? (tag << COUNT_BITS) | count : value + count;
+        if (counter.compare_exchange_weak(value, updated)) {
+            return static_cast<int64_t>(count) - static_cast<int64_t>(is_stale ? removed : 0);
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+struct RequestStatisticsOptions {
+    std::chrono::nanoseconds window = std::chrono::hours(24); // Длина скользящего окна
+    // Окно делится на интервалы, запросы выходят из окна целыми интервалами
+    size_t interval_count = 1440;
+    // Запрос не короче этого считается медленным
+    std::chrono::nanoseconds slow_request_duration = std::chrono::milliseconds(100);
+};
+
+// Бросит std::invalid_argument, если параметры некорректны
+void CheckRequestStatisticsOptions(const RequestStatisticsOptions &options);
+
+struct RequestCounts {
+    uint64_t total = 0;
+    uint64_t no_result = 0; // Запросы, не нашедшие ни одного документа
+    uint64_t slow = 0;
+};
+
+// Число запросов за последние window по монотонным часам. Окно - кольцо interval_count
+// интервалов со счётчиками и суммы счётчиков по кольцу. Запись запроса и чтение сумм
+// не берут блокировок и выполняются за O(1) из любого числа потоков.
+// Счётчик хранит в одном атомарном слове номер своего интервала и число запросов,
+// поэтому интервал, вышедший из окна, сбрасывается одной атомарной заменой и не теряет
+// запросов, записанных одновременно со сбросом. Интервалы, за которые не было запросов,
+// сбрасывает первый обратившийся после них поток
+class RequestStatistics {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Бросит std::invalid_argument, если параметры некорректны
+    explicit RequestStatistics(const RequestStatisticsOptions &options = {});
+
+    void Record(bool has_result, Clock::duration duration, Clock::time_point now = Clock::now());
+
+    // Суммы по окну, заканчивающемуся в now. now не раньше моментов, переданных ранее
+    RequestCounts GetCounts(Clock::time_point now = Clock::now()) const;
+
+    const RequestStatisticsOptions &GetOptions() const;
+
+private:
+    enum Counter {
+        TOTAL,
+        NO_RESULT,
+        SLOW,
+        COUNTER_COUNT,
+    };
+
+    // Старшие TAG_BITS бит слова счётчика - номер интервала по модулю 2^TAG_BITS, младшие - число запросов
+    static constexpr int TAG_BITS = 24;
+    static constexpr int COUNT_BITS = 64 - TAG_BITS;
+
+    struct alignas(64) Interval {
+        std::array<std::atomic<uint64_t>, COUNTER_COUNT> counters{};
+    };
+
+    RequestStatisticsOptions options_;
+    Clock::time_point start_;
+    Clock::duration interval_duration_;
+    std::unique_ptr<Interval[]> intervals_;
+    // Суммы счётчиков кольца. При гонке записи и сброса интервала сумма может ненадолго уйти
+    // ниже нуля, поэтому она знаковая
+    alignas(64) mutable std::array<std::atomic<int64_t>, COUNTER_COUNT> totals_{};
+    // Последний интервал, до которого сброшены устаревшие интервалы кольца
+    alignas(64) mutable std::atomic<int64_t> swept_interval_{0};
+
+    int64_t GetIntervalNumber(Clock::time_point now) const;
+
+    // Сбросит интервалы, вышедшие из окна к интервалу interval
+    void Sweep(int64_t interval) const;
+
+    // Добавит count запросов интервала interval в счётчик, сбросив его, если он хранит
+    // более старый интервал. Вернёт изменение суммы счётчиков кольца
+    int64_t AddToCounter(std::atomic<uint64_t> &counter, int64_t interval, uint64_t count) const;
+};
@@ -0,0 +1,55 @@
+#include "score_accumulator.h"
+
+void ScoreAccumulator::Reset(int first_document, size_t document_count) {
+    // Затронутые документы прерванного запроса сбрасываются по прежнему диапазону
+    Clear();
+    first_document_ = first_document;
+    if (relevances_.size() < document_count) {
+        relevances_.resize(document_count, 0.0);
+        states_.resize(document_count, State::UNTOUCHED);
+    }
+}
+
+bool ScoreAccumulator::IsTouched(int document) const {
+    return states_[document - first_document_] != State::UNTOUCHED;
+}
+
+bool ScoreAccumulator::IsRejected(int document) const {
+    return states_[document - first_document_] == State::REJECTED;
+}
+
+void ScoreAccumulator::Accept(int document) {
+    auto &state = states_[document - first_document_];
+    if (state == State::UNTOUCHED) {
+        touched_.push_back(document);
+    }
+    state = State::ACCEPTED;
+}
+
+void ScoreAccumulator::Reject(int document) {
+    auto &state = states_[document - first_document_];
+    if (state == State::UNTOUCHED) {
+        touched_.push_back(document);
+    }
+    state = State::REJECTED;
+}
+
+void ScoreAccumulator::Add(int document, double relevance) {
+    relevances_[document - first_document_] += relevance;
+}
+
+double ScoreAccumulator::GetRelevance(int document) const {
+    return relevances_[document - first_document_];
+}
+
+const std::vector<int> &ScoreAccumulator::GetTouched() const {
+    return touched_;
+}
+
+void ScoreAccumulator::Clear() {
+    for (const int document: touched_) {
+        relevances_[document - first_document_] = 0.0;
+        states_[document - first_document_] = State::UNTOUCHED;
+    }
+    touched_.clear();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Накопитель релевантности документов, адресуемый внутренним номером документа.
+// Релевантность копится в плоском массиве, номера затронутых документов
+// запоминаются, и между запросами сбрасываются только они
+class ScoreAccumulator {
+public:
+    // Подготовит накопитель для документов с номерами [first_document, first_document + document_count),
+    // сбросив затронутые документы, если Clear после прошлого запроса не вызывался
+    void Reset(int first_document, size_t document_count);
+
+    bool IsTouched(int document) const;
+
+    bool IsRejected(int document) const;
+
+    // Документ подходит под условия поиска и участвует в выдаче
+    void Accept(int document);
+
+    // Документ исключён из выдачи: не подошёл под условия поиска или содержит минус-слово
+    void Reject(int document);
+
+    void Add(int document, double relevance);
+
+    double GetRelevance(int document) const;
+
+    // Номера затронутых документов в порядке первого обращения
+    const std::vector<int> &GetTouched() const;
+
+    // Сбросит состояние затронутых документов
+    void Clear();
+
+private:
+    enum class State : uint8_t {
+        UNTOUCHED,
+        ACCEPTED,
+        REJECTED,
+    };
+
+    int first_document_ = 0;
+    std::vector<double> relevances_;
+    std::vector<State> states_;
+    std::vector<int> touched_;
+};
@@ -1,14 +1,15 @@
 #include "search_server.h"
 
-#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
 
 using std::string_literals::operator""s;
 
-std::set<int>::iterator SearchServer::begin() const {
+std::pmr::set<int>::iterator SearchServer::begin() const {
     return document_ids_.begin();
 }
 
-std::set<int>::iterator SearchServer::end() const {
+std::pmr::set<int>::iterator SearchServer::end() const {
     return document_ids_.end();
 }
 
@@ -18,27 +19,67 @@ void SearchServer::AddDocument(int document_id, std::string_view document,
 
     // Попытка добавить документ с отрицательным id или с id ранее добавленного
     // документа
-    if ((document_id < 0) || (documents_.count(document_id) > 0)) {
+    if ((document_id < 0) || (document_slots_.Find(document_id) != nullptr)) {
         throw std::invalid_argument("Invalid document id"s);
     }
 
-    documents_.emplace(document_id,
-                       DocumentData{
-                               ComputeAverageRating(ratings),
-                               status,
-                               std::string(document) // Оригинал строки
-                       });
-
-    auto &src_string = documents_.find(document_id)->second.data;
-    const std::vector<std::string_view> words = SplitIntoWordsNoStop(src_string);
+    // Текст разбирается до изменения индекса: при ошибке в тексте сервер не меняется
+    thread_local std::vector<std::string_view> words;
+    tokenizer_.Split(document, words);
     const double inv_word_count = 1.0 / words.size();
 
+    // ID слов документа, упорядоченные так, что повторы одного слова идут подряд
+    thread_local std::vector<TermId> term_ids;
+    term_ids.clear();
     for (const std::string_view word : words) {
-        word_to_document_freqs_[word][document_id] += inv_word_count;
-        document_to_word_freqs_[document_id][word] += inv_word_count;
+        term_ids.push_back(lexicon_.Intern(word));
+    }
+    std::sort(term_ids.begin(), term_ids.end());
+
+    // Новых слов у копии нет, поэтому отказ не оставляет в словаре слов без документов
+    TermSetFingerprint fingerprint;
+    if (duplicate_policy_ == DuplicatePolicy::REJECT) {
+        thread_local std::vector<TermId> unique_term_ids;
+        unique_term_ids.assign(term_ids.begin(), std::unique(term_ids.begin(), term_ids.end()));
+        fingerprint = ComputeTermSetFingerprint(unique_term_ids);
+        if (const auto original_id = FindDuplicate(fingerprint, unique_term_ids)) {
+            throw DuplicateDocumentError(document_id, *original_id);
+        }
     }
 
+    const auto slot = static_cast<int>(documents_.size());
+    documents_.GetMutable(slot) = {document_id, ComputeAverageRating(ratings), status, false};
+    document_texts_.push_back(document_text_arena_.Add(document));
+    document_slots_.GetMutable(document_id) = slot;
+    write_segment_.AddDocument(inv_word_count);
+
+    auto &word_freqs = document_to_word_freqs_[document_id];
+    for (auto it = term_ids.begin(); it != term_ids.end();) {
+        const TermId term_id = *it;
+        const auto run_end = std::find_if(it, term_ids.end(), [term_id](TermId other) {
+            return other != term_id;
+        });
+        const auto term_count = static_cast<uint32_t>(run_end - it);
+        const double term_freq = term_count * inv_word_count;
+        word_freqs.emplace_hint(word_freqs.end(), term_id, term_freq);
+        write_segment_.AddTerm(term_id).Add(slot - write_segment_.GetFirstSlot(), term_count, term_freq);
+        term_statistics_.GetMutable(term_id).AddDocuments(1);
+        it = run_end;
+    }
+    collection_statistics_.AddDocuments(1);
+
     document_ids_.insert(document_id);
+    if (duplicate_policy_ == DuplicatePolicy::REJECT) {
+        duplicate_index_.Insert(fingerprint, document_id);
+    }
+    ++generation_;
+    UpdateSegments();
+    Publish();
+}
+
+// Добавление пакета документов.
+void SearchServer::AddDocuments(const std::vector<NewDocument> &documents) {
+    AddDocuments(std::execution::seq, documents);
 }
 
 // Удаление документа по ID.
@@ -46,12 +87,27 @@ void SearchServer::RemoveDocument(int document_id) {
     return RemoveDocument(std::execution::seq, document_id);
 }
 
+// Удаление пакета документов.
+void SearchServer::RemoveDocuments(const std::vector<int> &document_ids) {
+    bool is_changed = false;
+    for (const int document_id : document_ids) {
+        is_changed |= MarkRemoved(document_id);
+    }
+    if (!is_changed) {
+        return;
+    }
+    UpdateSegments();
+    Publish();
+}
+
 // Поиск документов по запросу + статусу.
-std::vector<Document> SearchServer::FindTopDocuments(const std::string_view &raw_query, DocumentStatus status) const {
+std::vector<Document> SearchServer::FindTopDocuments(const std::string_view &raw_query, DocumentStatus status,
+                                                     size_t top_count) const {
     return FindTopDocuments(
             std::execution::seq, raw_query, [status](int document_id, DocumentStatus document_status, int rating) {
                 return document_status == status;
-            });
+            },
+            top_count);
 }
 
 // Поиск документов по запросу
@@ -60,9 +116,9 @@ std::vector<Document> SearchServer::FindTopDocuments(const std::string_view &raw
 }
 
 // Метод получения частот слов по id документа.
-const std::map<std::string_view, double> &SearchServer::GetWordFrequencies(int document_id) const {
-    static const std::map<std::string_view, double> empty_map;
-    if (document_id < 0 || documents_.count(document_id) == 0) {
+const std::pmr::map<TermId, double> &SearchServer::GetWordFrequencies(int document_id) const {
+    static const std::pmr::map<TermId, double> empty_map;
+    if (document_id < 0 || document_slots_.Find(document_id) == nullptr) {
         return empty_map;
     }
     return document_to_word_freqs_.at(document_id);
@@ -70,7 +126,8 @@ const std::map<std::string_view, double> &SearchServer::GetWordFrequencies(int d
 
 // Получение кол-ва документов.
 int SearchServer::GetDocumentCount() const {
-    return documents_.size();
+    const auto guard = reclaimer_.Pin();
+    return static_cast<int>(published_version_.load()->document_slots.size());
 }
 
 // Получить кортеж из слов и статуса документа по запросу.
@@ -80,86 +137,207 @@ SearchServer::MatchDocument(const std::string_view raw_query, int document_id) c
 }
 
 std::tuple<std::vector<std::string_view>, DocumentStatus>
-SearchServer::MatchDocument(const std::execution::sequenced_policy&,
+SearchServer::MatchDocument(const std::execution::sequenced_policy &policy,
                             const std::string_view raw_query, int document_id) const {
-    const Query query = ParseQuery(raw_query);
-    const auto status = documents_.at(document_id).status;
-
-    for (const std::string_view word : query.minus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
-        }
-        if (word_to_document_freqs_.at(word).count(document_id) > 0) {
-            return {std::vector<std::string_view>(), status};
-        }
-    }
-
-    std::vector<std::string_view> matched_words;
-    for (const std::string_view word : query.plus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
-        }
-        if (word_to_document_freqs_.at(word).count(document_id) > 0) {
-            matched_words.push_back(word);
-        }
-    }
-
-    return {matched_words, status};
+    const auto guard = reclaimer_.Pin();
+    return MatchDocument(policy, tokenizer_, *published_version_.load(), raw_query, document_id);
 }
 
 std::tuple<std::vector<std::string_view>, DocumentStatus>
-SearchServer::MatchDocument(const std::execution::parallel_policy&,
+SearchServer::MatchDocument(const std::execution::parallel_policy &policy,
                             std::string_view raw_query, int document_id) const {
+    const auto guard = reclaimer_.Pin();
+    return MatchDocument(policy, tokenizer_, *published_version_.load(), raw_query, document_id);
+}
 
-    const auto query = ParseQuery(raw_query, false);
-    const auto status = documents_.at(document_id).status;
-    const auto word_checker =
-            [this, document_id](std::string_view word) {
-                const auto it = word_to_document_freqs_.find(word);
-                return it != word_to_document_freqs_.end() && it->second.count(document_id);
-            };
+bool SearchServer::IsValidWord(const std::string_view word) {
+    return std::none_of(word.begin(), word.end(), [](char c) {
+        return c >= '\0' && c < ' ';
+    });
+}
 
-    if (any_of(std::execution::par, query.minus_words.begin(), query.minus_words.end(), word_checker)) {
-        return {std::vector<std::string_view>(), status};
+void SearchServer::CheckNewDocumentIds(const std::vector<NewDocument> &documents) const {
+    std::unordered_set<int> batch_ids;
+    for (const auto &document : documents) {
+        if (document.id < 0 || document_slots_.Find(document.id) != nullptr || !batch_ids.insert(document.id).second) {
+            throw std::invalid_argument("Invalid document id"s);
+        }
     }
+}
 
-    std::vector<std::string_view> matched_words(query.plus_words.size());
-    auto words_end = copy_if(
-            std::execution::par,
-            query.plus_words.begin(), query.plus_words.end(),
-            matched_words.begin(),
-            word_checker
-    );
+std::optional<int> SearchServer::FindDuplicate(const TermSetFingerprint &fingerprint,
+                                               const std::vector<TermId> &term_ids) const {
+    return duplicate_index_.Find(fingerprint, [this, &term_ids](int document_id) {
+        const auto &word_freqs = document_to_word_freqs_.at(document_id);
+        return word_freqs.size() == term_ids.size()
+               && std::equal(word_freqs.begin(), word_freqs.end(), term_ids.begin(),
+                             [](const auto &word_freq, TermId term_id) {
+                                 return word_freq.first == term_id;
+                             });
+    });
+}
 
-    sort(matched_words.begin(), words_end);
-    words_end = unique(matched_words.begin(), words_end);
-    matched_words.erase(words_end, matched_words.end());
+std::vector<TermSetFingerprint> SearchServer::CheckNewDocumentDuplicates(const std::vector<NewDocument> &documents,
+                                                                         const std::vector<PartialIndex> &parts) const {
+    std::vector<TermSetFingerprint> fingerprints;
+    fingerprints.reserve(documents.size());
+    // Наборы слов уже проверенных документов пакета по их отпечаткам
+    std::unordered_multimap<TermSetFingerprint, std::pair<size_t, std::vector<TermId>>,
+                            TermSetFingerprintHasher> batch_term_ids;
+    std::vector<TermId> term_ids;
+    for (const auto &part : parts) {
+        size_t terms_begin = 0;
+        for (size_t document = 0; document < part.document_term_ends.size(); ++document) {
+            term_ids.clear();
+            for (size_t term = terms_begin; term < part.document_term_ends[document]; ++term) {
+                term_ids.push_back(part.term_ids[part.document_terms[term].first]);
+            }
+            terms_begin = part.document_term_ends[document];
+            std::sort(term_ids.begin(), term_ids.end());
 
-    return {matched_words, status};
+            const auto &new_document = documents[part.first_document + document];
+            const auto fingerprint = ComputeTermSetFingerprint(term_ids);
+            if (const auto original_id = FindDuplicate(fingerprint, term_ids)) {
+                throw DuplicateDocumentError(new_document.id, *original_id);
+            }
+            const auto [first, last] = batch_term_ids.equal_range(fingerprint);
+            for (auto it = first; it != last; ++it) {
+                if (it->second.second == term_ids) {
+                    throw DuplicateDocumentError(new_document.id, documents[it->second.first].id);
+                }
+            }
+            batch_term_ids.emplace(fingerprint, std::pair{part.first_document + document, term_ids});
+            fingerprints.push_back(fingerprint);
+        }
+    }
+    return fingerprints;
 }
 
-// возвращает кортеж из общих слов и статуса документа по запросу
-bool SearchServer::IsStopWord(const std::string_view word) const {
-    return stop_words_.count(std::string(word)) > 0;
+SearchServer::PartialIndex SearchServer::BuildPartialIndex(const std::vector<NewDocument> &documents,
+                                                           size_t first, size_t last) const {
+    PartialIndex part;
+    part.first_document = first;
+    part.inv_word_counts.reserve(last - first);
+    part.document_term_ends.reserve(last - first);
+    try {
+        std::unordered_map<std::string_view, uint32_t> local_term_ids;
+        std::vector<std::string_view> words;
+        std::vector<uint32_t> term_ids;
+        for (size_t i = first; i < last; ++i) {
+            tokenizer_.Split(documents[i].text, words);
+            part.inv_word_counts.push_back(1.0 / words.size());
+
+            term_ids.clear();
+            for (const std::string_view word : words) {
+                const auto [it, inserted] = local_term_ids.emplace(word, static_cast<uint32_t>(part.terms.size()));
+                if (inserted) {
+                    part.terms.push_back(word);
+                    part.postings.emplace_back();
+                }
+                term_ids.push_back(it->second);
+            }
+            std::sort(term_ids.begin(), term_ids.end());
+            const auto document = static_cast<uint32_t>(i - first);
+            for (auto it = term_ids.begin(); it != term_ids.end();) {
+                const uint32_t term_id = *it;
+                const auto run_end = std::find_if(it, term_ids.end(), [term_id](uint32_t other) {
+                    return other != term_id;
+                });
+                const auto term_count = static_cast<uint32_t>(run_end - it);
+                part.postings[term_id].emplace_back(document, term_count);
+                part.document_terms.emplace_back(term_id, term_count);
+                it = run_end;
+            }
+            part.document_term_ends.push_back(part.document_terms.size());
+        }
+    } catch (...) {
+        part.error = std::current_exception();
+    }
+    return part;
 }
 
-bool SearchServer::IsValidWord(const std::string_view word) {
-    return std::none_of(word.begin(), word.end(), [](char c) {
-        return c >= '\0' && c < ' ';
-    });
+void SearchServer::MergePartialPostings(const std::vector<PartialIndex> &parts, int first_slot,
+                                        size_t group, size_t group_count) {
+    for (const auto &part : parts) {
+        // Списки сегмента хранят номера документов относительно его начала
+        const int part_offset = first_slot - write_segment_.GetFirstSlot() + static_cast<int>(part.first_document);
+        for (size_t local_term_id = 0; local_term_id < part.terms.size(); ++local_term_id) {
+            const TermId term_id = part.term_ids[local_term_id];
+            if (term_id % group_count != group) {
+                continue;
+            }
+            const auto &postings = part.postings[local_term_id];
+            PostingList &term_postings = write_segment_.GetPostings(term_id);
+            for (const auto &[document, term_count] : postings) {
+                term_postings.Add(part_offset + static_cast<int>(document), term_count,
+                                  term_count * part.inv_word_counts[document]);
+            }
+        }
+    }
 }
 
-std::vector<std::string_view> SearchServer::SplitIntoWordsNoStop(const std::string_view &text) const {
-    std::vector<std::string_view> words;
-    for (const std::string_view &word: SplitIntoWords(text)) {
-        if (!IsValidWord(word)) {
-            throw std::invalid_argument("Special character detected");
-        }
-        if (!IsStopWord(word)) {
-            words.push_back(word);
+void SearchServer::FillPartialWordFreqs(PartialIndex &part) {
+    part.word_freqs.reserve(part.document_terms.size());
+    size_t terms_begin = 0;
+    for (size_t document = 0; document < part.inv_word_counts.size(); ++document) {
+        const size_t terms_end = part.document_term_ends[document];
+        for (size_t term = terms_begin; term < terms_end; ++term) {
+            const auto [local_term_id, term_count] = part.document_terms[term];
+            part.word_freqs.emplace_back(part.term_ids[local_term_id], term_count * part.inv_word_counts[document]);
         }
+        std::sort(part.word_freqs.begin() + static_cast<std::ptrdiff_t>(terms_begin), part.word_freqs.end());
+        terms_begin = terms_end;
+    }
+}
+
+bool SearchServer::MarkRemoved(int document_id) {
+    const auto word_freqs = document_to_word_freqs_.find(document_id);
+    if (word_freqs == document_to_word_freqs_.end()) {
+        return false;
+    }
+
+    // Документ остаётся в списках вхождений до переписывания его сегмента,
+    // но сразу перестаёт учитываться в статистике и находиться поиском
+    const int slot = document_slots_.at(document_id);
+    for (const auto &[term_id, term_freq] : word_freqs->second) {
+        term_statistics_.GetMutable(term_id).AddDocuments(-1);
     }
-    return words;
+    collection_statistics_.AddDocuments(-1);
+    documents_.GetMutable(slot).is_removed = true;
+    if (slot >= write_segment_.GetFirstSlot()) {
+        ++write_segment_removed_count_;
+    } else {
+        const auto segment = std::upper_bound(segments_.begin(), segments_.end(), slot,
+                                              [](int slot, const std::shared_ptr<const IndexSegment> &segment) {
+                                                  return slot < segment->GetFirstSlot();
+                                              });
+        ++segment_removed_counts_[std::prev(segment) - segments_.begin()];
+    }
+
+    // Текст удалённого документа освобождается сразу, а номер - когда слияние отбросит документ
+    removed_text_size_ += document_texts_[slot].size();
+    document_texts_[slot] = {};
+    if (removed_text_size_ > document_text_arena_.GetChunkSize()
+        && 2 * removed_text_size_ > document_text_arena_.GetSize()) {
+        CompactDocumentTexts();
+    }
+    if (duplicate_policy_ == DuplicatePolicy::REJECT) {
+        duplicate_index_.Erase(ComputeTermSetFingerprint(word_freqs->second), document_id);
+    }
+    document_to_word_freqs_.erase(word_freqs);
+    document_slots_.Erase(document_id);
+    document_ids_.erase(document_id);
+    ++generation_;
+    return true;
+}
+
+void SearchServer::CompactDocumentTexts() {
+    TextArena arena(document_text_arena_.GetChunkSize());
+    for (auto &text : document_texts_) {
+        text = arena.Add(text);
+    }
+    document_text_arena_ = std::move(arena);
+    removed_text_size_ = 0;
 }
 
 int SearchServer::ComputeAverageRating(const std::vector<int> &ratings) {
@@ -170,7 +348,7 @@ int SearchServer::ComputeAverageRating(const std::vector<int> &ratings) {
     return rating_sum / static_cast<int>(ratings.size());
 }
 
-SearchServer::QueryWord SearchServer::ParseQueryWord(const std::string_view &text) const {
+SearchServer::QueryWord SearchServer::ParseQueryWord(const Tokenizer &tokenizer, const std::string_view &text) {
     if (text.empty()) {
         throw std::invalid_argument("Query word is empty");
     }
@@ -184,37 +362,600 @@ SearchServer::QueryWord SearchServer::ParseQueryWord(const std::string_view &tex
         throw std::invalid_argument("Query word is invalid");
     }
 
-    return {word, is_minus, IsStopWord(word)};
+    return {word, is_minus, tokenizer.IsStopWord(word)};
+}
+
+void SearchServer::UpdateSegments(bool wait) {
+    if (merge_.valid() && (wait || merge_.wait_for(std::chrono::seconds(0)) == std::future_status::ready)) {
+        // Пока шло слияние, сегменты только дописывались в конец, поэтому исходные сегменты стоят подряд
+        const auto merged = merge_.get();
+        const auto first = std::find(segments_.begin(), segments_.end(), merge_sources_.front()) - segments_.begin();
+        const auto last = first + static_cast<std::ptrdiff_t>(merge_sources_.size());
+        segments_.insert(segments_.erase(segments_.begin() + first, segments_.begin() + last), merged);
+        // В слитом сегменте остались только документы, удалённые во время слияния
+        const auto removed_counts = segment_removed_counts_.begin();
+        const size_t removed_count = std::accumulate(removed_counts + first, removed_counts + last, size_t{0});
+        segment_removed_counts_.insert(segment_removed_counts_.erase(removed_counts + first, removed_counts + last),
+                                       removed_count - merge_dropped_count_);
+        merge_sources_.clear();
+        if (merge_dropped_count_ > 0) {
+            // Слитый сегмент короче исходных на отброшенные документы: сегменты после него сдвигаются
+            RenumberSlots(merged->GetFirstSlot(), merge_removed_slots_);
+            const auto dropped_count = static_cast<int>(merge_dropped_count_);
+            for (auto it = segments_.begin() + first + 1; it != segments_.end(); ++it) {
+                auto segment = std::make_shared<IndexSegment>(**it);
+                segment->SetFirstSlot(segment->GetFirstSlot() - dropped_count);
+                *it = std::move(segment);
+            }
+            write_segment_.SetFirstSlot(write_segment_.GetFirstSlot() - dropped_count);
+        }
+        merge_removed_slots_.clear();
+    }
+
+    if (write_segment_.GetDocumentCount() >= merge_policy_.write_segment_size) {
+        write_segment_.Compact();
+        const int last_slot = write_segment_.GetLastSlot();
+        segments_.push_back(std::make_shared<const IndexSegment>(std::move(write_segment_)));
+        segment_removed_counts_.push_back(write_segment_removed_count_);
+        write_segment_ = IndexSegment(last_slot);
+        write_segment_removed_count_ = 0;
+    }
+
+    if (merge_.valid()) {
+        return;
+    }
+    std::vector<size_t> segment_sizes;
+    segment_sizes.reserve(segments_.size());
+    for (const auto &segment: segments_) {
+        segment_sizes.push_back(segment->GetDocumentCount());
+    }
+    auto merge_range = FindSegmentsToMerge(segment_sizes, merge_policy_);
+    if (!merge_range) {
+        // Сегмент с большой долей удалённых документов переписывается сам с собой
+        if (const auto segment = FindSegmentToCompact(segment_sizes, segment_removed_counts_, merge_policy_)) {
+            merge_range = std::pair{*segment, *segment + 1};
+        } else {
+            return;
+        }
+    }
+    merge_sources_.assign(segments_.begin() + static_cast<std::ptrdiff_t>(merge_range->first),
+                          segments_.begin() + static_cast<std::ptrdiff_t>(merge_range->second));
+    const auto removed_counts = segment_removed_counts_.begin();
+    merge_dropped_count_ = std::accumulate(removed_counts + static_cast<std::ptrdiff_t>(merge_range->first),
+                                           removed_counts + static_cast<std::ptrdiff_t>(merge_range->second),
+                                           size_t{0});
+    // Слиянию передаётся копия признаков удаления: сервер продолжает их менять.
+    // По ней же документы перенумеровываются, когда слияние подключается
+    const int first_slot = merge_sources_.front()->GetFirstSlot();
+    const int last_slot = merge_sources_.back()->GetLastSlot();
+    merge_removed_slots_.assign(last_slot - first_slot, false);
+    for (int slot = first_slot; slot < last_slot; ++slot) {
+        merge_removed_slots_[slot - first_slot] = documents_[slot].is_removed;
+    }
+    merge_ = std::async(std::launch::async,
+                        [sources = merge_sources_, removed_slots = merge_removed_slots_] {
+                            return std::make_shared<const IndexSegment>(IndexSegment::Merge(sources, removed_slots));
+                        });
+}
+
+void SearchServer::RenumberSlots(int first_slot, const std::vector<bool> &removed_slots) {
+    const auto slot_count = static_cast<int>(documents_.size());
+    int new_slot = first_slot;
+    for (int slot = first_slot; slot < slot_count; ++slot) {
+        const auto offset = static_cast<size_t>(slot - first_slot);
+        if (offset < removed_slots.size() && removed_slots[offset]) {
+            continue;
+        }
+        if (slot != new_slot) {
+            const DocumentData document = documents_[slot];
+            documents_.GetMutable(new_slot) = document;
+            // Документ, удалённый во время слияния, уже убран из document_slots_
+            if (!document.is_removed) {
+                document_slots_.GetMutable(document.id) = new_slot;
+            }
+            document_texts_[new_slot] = document_texts_[slot];
+        }
+        ++new_slot;
+    }
+    for (int slot = new_slot; slot < slot_count; ++slot) {
+        documents_.Erase(slot);
+    }
+    document_texts_.resize(new_slot);
+}
+
+void SearchServer::Publish() {
+    IndexVersion new_version{lexicon_.GetSnapshot(), segments_, term_statistics_, collection_statistics_,
+                             documents_, document_slots_, generation_};
+    if (write_segment_.GetDocumentCount() > 0) {
+        // Копия делит списки с изменяемым сегментом, который копирует их при следующем пополнении
+        new_version.segments.push_back(std::make_shared<const IndexSegment>(write_segment_));
+    }
+    auto version = std::make_shared<const IndexVersion>(std::move(new_version));
+    published_version_.store(version.get());
+    reclaimer_.Retire(std::move(published_version_owner_));
+    published_version_owner_ = std::move(version);
+    reclaimer_.Collect();
+}
+
+void SearchServer::SetMergePolicy(const MergePolicy &policy) {
+    CheckMergePolicy(policy);
+    merge_policy_ = policy;
+    UpdateSegments();
+    Publish();
+}
+
+void SearchServer::SetDuplicatePolicy(DuplicatePolicy policy) {
+    duplicate_policy_ = policy;
+    duplicate_index_.Clear();
+    if (policy == DuplicatePolicy::REJECT) {
+        for (const auto &[document_id, word_freqs] : document_to_word_freqs_) {
+            duplicate_index_.Insert(ComputeTermSetFingerprint(word_freqs), document_id);
+        }
+    }
+}
+
+void SearchServer::SetQueryCacheOptions(const QueryCacheOptions &options) {
+    CheckQueryCacheOptions(options);
+    query_cache_ = options.capacity == 0 ? nullptr : std::make_unique<QueryCache>(options);
 }
 
-SearchServer::Query SearchServer::ParseQuery(const std::string_view &text,
-                                             bool make_uniq) const {
-    Query result;
-    for (const std::string_view word: SplitIntoWords(text)) {
-        const auto query_word = ParseQueryWord(word);
-        if (!query_word.is_stop) {
-            if (query_word.is_minus) {
-                result.minus_words.push_back(query_word.data);
-            } else {
-                result.plus_words.push_back(query_word.data);
+QueryCacheStatistics SearchServer::GetQueryCacheStatistics() const {
+    return query_cache_ ? query_cache_->GetStatistics() : QueryCacheStatistics{};
+}
+
+void SearchServer::WaitForMerges() {
+    while (merge_.valid()) {
+        UpdateSegments(true);
+    }
+    Publish();
+}
+
+size_t SearchServer::GetSegmentCount() const {
+    return segments_.size();
+}
+
+ScoreAccumulator &SearchServer::GetThreadAccumulator() {
+    // Один накопитель на поток: его массивы растут до самого большого диапазона поиска
+    static thread_local ScoreAccumulator accumulator;
+    return accumulator;
+}
+
+struct SearchServer::LoadedSnapshot {
+    Lexicon *lexicon = nullptr; // Словарь создаваемого сервера, заполняется на месте
+    size_t term_count = 0;
+    MergePolicy merge_policy;
+    int document_count = 0;
+    size_t write_segment_removed_count = 0;
+    std::vector<size_t> segment_removed_counts;
+    std::vector<int> document_freqs; // ID слова - документная частота
+    std::vector<DocumentData> documents; // По внутренним номерам
+    std::vector<std::string_view> document_texts; // Указывают в данные снимка
+    bool has_document_texts = false;
+    // Частоты слов документов в формате секции, ID документов по возрастанию.
+    // Словари из них строит пишущий поток в ресурсе памяти сервера
+    SnapshotArray<int> word_freq_ids;
+    SnapshotArray<uint32_t> word_counts;
+    SnapshotArray<TermId> term_ids;
+    SnapshotArray<double> term_freqs;
+    std::vector<std::shared_ptr<IndexSegment>> segments;
+};
+
+void SearchServer::Save(const std::string &path, bool with_texts) const {
+    std::vector<std::pair<SnapshotSectionType, std::string>> sections;
+
+    SnapshotWriter stop_words;
+    const auto &stop_words_list = tokenizer_.GetStopWords();
+    stop_words.Write<uint64_t>(stop_words_list.size());
+    for (const auto &word : stop_words_list) {
+        stop_words.WriteString(word);
+    }
+    sections.emplace_back(SnapshotSectionType::STOP_WORDS, std::move(stop_words.GetData()));
+
+    SnapshotWriter lexicon;
+    lexicon_.Save(lexicon);
+    sections.emplace_back(SnapshotSectionType::LEXICON, std::move(lexicon.GetData()));
+
+    SnapshotWriter state;
+    state.Write<uint64_t>(merge_policy_.write_segment_size);
+    state.Write<uint64_t>(merge_policy_.merge_factor);
+    state.Write(merge_policy_.max_removed_ratio);
+    state.Write(collection_statistics_.document_count);
+    state.Write<uint64_t>(write_segment_removed_count_);
+    state.WriteArray(std::vector<uint64_t>(segment_removed_counts_.begin(), segment_removed_counts_.end()));
+    sections.emplace_back(SnapshotSectionType::SERVER_STATE, std::move(state.GetData()));
+
+    // Логарифмы частот записываются вместе с частотами: отображённый снимок читает их как есть
+    std::vector<int> document_freqs(lexicon_.size());
+    std::vector<double> log_document_freqs(lexicon_.size());
+    term_statistics_.ForEach([&](TermId term_id, const TermStatistics &statistics) {
+        document_freqs[term_id] = statistics.document_freq;
+        log_document_freqs[term_id] = statistics.log_document_freq;
+    });
+    SnapshotWriter term_statistics;
+    term_statistics.WriteArray(document_freqs);
+    term_statistics.WriteArray(log_document_freqs);
+    sections.emplace_back(SnapshotSectionType::TERM_STATISTICS, std::move(term_statistics.GetData()));
+
+    // Кроме данных по номерам, записываются ID живых документов по возрастанию и их номера:
+    // по ним отображённый в память снимок находит документ по ID
+    std::vector<int> ids, ratings, statuses;
+    std::vector<uint8_t> removed;
+    for (int slot = 0; slot < static_cast<int>(documents_.size()); ++slot) {
+        const auto &document = documents_[slot];
+        ids.push_back(document.id);
+        ratings.push_back(document.rating);
+        statuses.push_back(static_cast<int>(document.status));
+        removed.push_back(document.is_removed);
+    }
+    std::vector<int> live_ids(document_ids_.begin(), document_ids_.end());
+    std::vector<int> live_slots;
+    live_slots.reserve(live_ids.size());
+    for (const int document_id : live_ids) {
+        live_slots.push_back(*document_slots_.Find(document_id));
+    }
+    SnapshotWriter documents;
+    documents.WriteArray(ids);
+    documents.WriteArray(ratings);
+    documents.WriteArray(statuses);
+    documents.WriteArray(removed);
+    documents.WriteArray(live_ids);
+    documents.WriteArray(live_slots);
+    sections.emplace_back(SnapshotSectionType::DOCUMENTS, std::move(documents.GetData()));
+
+    if (with_texts) {
+        SnapshotWriter texts;
+        texts.Write<uint64_t>(document_texts_.size());
+        for (const auto &text : document_texts_) {
+            texts.WriteString(text);
+        }
+        sections.emplace_back(SnapshotSectionType::DOCUMENT_TEXTS, std::move(texts.GetData()));
+    }
+
+    // Частоты слов документов - плоскими массивами: ID документов, число их слов, слова и частоты подряд
+    std::vector<int> word_freq_ids;
+    std::vector<uint32_t> word_counts;
+    std::vector<TermId> term_ids;
+    std::vector<double> term_freqs;
+    for (const auto &[document_id, word_freqs] : document_to_word_freqs_) {
+        word_freq_ids.push_back(document_id);
+        word_counts.push_back(static_cast<uint32_t>(word_freqs.size()));
+        for (const auto &[term_id, term_freq] : word_freqs) {
+            term_ids.push_back(term_id);
+            term_freqs.push_back(term_freq);
+        }
+    }
+    SnapshotWriter word_freqs;
+    word_freqs.WriteArray(word_freq_ids);
+    word_freqs.WriteArray(word_counts);
+    word_freqs.WriteArray(term_ids);
+    word_freqs.WriteArray(term_freqs);
+    sections.emplace_back(SnapshotSectionType::WORD_FREQUENCIES, std::move(word_freqs.GetData()));
+
+    // Сегменты - самая объёмная часть снимка, они записываются в буферы параллельно
+    std::vector<const IndexSegment *> segments;
+    for (const auto &segment : segments_) {
+        segments.push_back(segment.get());
+    }
+    segments.push_back(&write_segment_);
+    std::vector<std::string> segment_data(segments.size());
+    std::transform(std::execution::par, segments.begin(), segments.end(), segment_data.begin(),
+                   [](const IndexSegment *segment) {
+                       SnapshotWriter writer;
+                       segment->Save(writer);
+                       return std::move(writer.GetData());
+                   });
+    for (auto &data : segment_data) {
+        sections.emplace_back(SnapshotSectionType::SEGMENT, std::move(data));
+    }
+
+    WriteSnapshotFile(path, sections);
+}
+
+void SearchServer::LoadSnapshotSection(const SnapshotSection &section, size_t segment, LoadedSnapshot &loaded) {
+    CheckSnapshotSection(section);
+    SnapshotReader reader(section.data);
+    switch (section.type) {
+        case SnapshotSectionType::LEXICON:
+            Lexicon::Load(reader, *loaded.lexicon);
+            loaded.term_count = loaded.lexicon->size();
+            break;
+        case SnapshotSectionType::SERVER_STATE: {
+            loaded.merge_policy.write_segment_size = reader.Read<uint64_t>();
+            loaded.merge_policy.merge_factor = reader.Read<uint64_t>();
+            loaded.merge_policy.max_removed_ratio = reader.Read<double>();
+            loaded.document_count = reader.Read<int>();
+            loaded.write_segment_removed_count = reader.Read<uint64_t>();
+            std::vector<uint64_t> removed_counts;
+            reader.ReadArray(removed_counts);
+            loaded.segment_removed_counts.assign(removed_counts.begin(), removed_counts.end());
+            break;
+        }
+        case SnapshotSectionType::TERM_STATISTICS:
+            reader.ReadArray(loaded.document_freqs);
+            // Логарифмы пересчитываются по частотам
+            if (reader.ReadArrayView<double>().size() != loaded.document_freqs.size()) {
+                ThrowSnapshotCorrupted();
+            }
+            break;
+        case SnapshotSectionType::DOCUMENTS: {
+            std::vector<int> ids, ratings, statuses;
+            std::vector<uint8_t> removed;
+            reader.ReadArray(ids);
+            reader.ReadArray(ratings);
+            reader.ReadArray(statuses);
+            reader.ReadArray(removed);
+            // ID живых документов и их номера восстанавливаются по данным документов
+            const auto live_ids = reader.ReadArrayView<int>();
+            const auto live_slots = reader.ReadArrayView<int>();
+            if (ratings.size() != ids.size() || statuses.size() != ids.size() || removed.size() != ids.size()
+                || live_slots.size() != live_ids.size()) {
+                ThrowSnapshotCorrupted();
+            }
+            loaded.documents.reserve(ids.size());
+            for (size_t slot = 0; slot < ids.size(); ++slot) {
+                loaded.documents.push_back({ids[slot], ratings[slot], static_cast<DocumentStatus>(statuses[slot]),
+                                            removed[slot] != 0});
+            }
+            break;
+        }
+        case SnapshotSectionType::DOCUMENT_TEXTS: {
+            const auto text_count = reader.Read<uint64_t>();
+            for (uint64_t i = 0; i < text_count; ++i) {
+                loaded.document_texts.emplace_back(reader.ReadString());
             }
+            loaded.has_document_texts = true;
+            break;
         }
+        case SnapshotSectionType::WORD_FREQUENCIES: {
+            loaded.word_freq_ids = reader.ReadArrayView<int>();
+            loaded.word_counts = reader.ReadArrayView<uint32_t>();
+            loaded.term_ids = reader.ReadArrayView<TermId>();
+            loaded.term_freqs = reader.ReadArrayView<double>();
+            if (loaded.word_counts.size() != loaded.word_freq_ids.size()
+                || loaded.term_freqs.size() != loaded.term_ids.size()) {
+                ThrowSnapshotCorrupted();
+            }
+            size_t term_count = 0;
+            for (const uint32_t word_count : loaded.word_counts) {
+                term_count += word_count;
+            }
+            if (term_count != loaded.term_ids.size()) {
+                ThrowSnapshotCorrupted();
+            }
+            break;
+        }
+        case SnapshotSectionType::SEGMENT:
+            loaded.segments[segment] = std::make_shared<IndexSegment>(IndexSegment::Load(reader));
+            break;
+        default:
+            // Стоп-слова разобраны до создания сервера, неизвестные секции пропускаются
+            return;
+    }
+    if (!reader.IsEnd()) {
+        ThrowSnapshotCorrupted();
+    }
+}
+
+std::unique_ptr<SearchServer> SearchServer::Load(const std::string &path,
+                                                const AllocationOptions &allocation_options) {
+    std::string data;
+    const auto sections = ReadSnapshotFile(path, data);
+
+    // Стоп-слова нужны для создания сервера, остальные секции разбираются параллельно
+    const auto stop_words_section = std::find_if(sections.begin(), sections.end(), [](const auto &section) {
+        return section.type == SnapshotSectionType::STOP_WORDS;
+    });
+    if (stop_words_section == sections.end()) {
+        ThrowSnapshotCorrupted();
+    }
+    CheckSnapshotSection(*stop_words_section);
+    SnapshotReader stop_words_reader(stop_words_section->data);
+    std::set<std::string> stop_words;
+    for (auto word_count = stop_words_reader.Read<uint64_t>(); word_count > 0; --word_count) {
+        stop_words.emplace(stop_words_reader.ReadString());
     }
-    if (make_uniq) {
-        // Удаление дубликатов из векторов "плюс" и "минус" слов
-        for (auto *word : {&result.plus_words, &result.minus_words}) {
-            std::sort(word->begin(), word->end());
-            auto trash_pos = std::unique(word->begin(), word->end());
-            word->erase(trash_pos, word->end());
+    auto server = std::make_unique<SearchServer>(stop_words, allocation_options);
+
+    LoadedSnapshot loaded;
+    loaded.lexicon = &server->lexicon_;
+    std::vector<size_t> segment_indexes(sections.size());
+    size_t segment_count = 0;
+    std::set<SnapshotSectionType> section_types;
+    for (size_t i = 0; i < sections.size(); ++i) {
+        if (sections[i].type == SnapshotSectionType::SEGMENT) {
+            segment_indexes[i] = segment_count++;
+        } else if (!section_types.insert(sections[i].type).second) {
+            // Секции разбираются в общий LoadedSnapshot, повтор секции дал бы гонку
+            ThrowSnapshotCorrupted();
         }
     }
+    if (segment_count == 0) {
+        ThrowSnapshotCorrupted();
+    }
+    loaded.segments.resize(segment_count);
+    std::vector<std::exception_ptr> errors(sections.size());
+    std::vector<size_t> section_indexes(sections.size());
+    std::iota(section_indexes.begin(), section_indexes.end(), 0);
+    std::for_each(std::execution::par, section_indexes.begin(), section_indexes.end(),
+                  [&](size_t i) {
+                      try {
+                          LoadSnapshotSection(sections[i], segment_indexes[i], loaded);
+                      } catch (...) {
+                          errors[i] = std::current_exception();
+                      }
+                  });
+    for (const auto &error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    const auto slot_count = static_cast<int>(loaded.documents.size());
+    if (loaded.segment_removed_counts.size() != segment_count - 1
+        || loaded.document_freqs.size() != loaded.term_count
+        || (loaded.has_document_texts && loaded.document_texts.size() != loaded.documents.size())
+        || loaded.segments.back()->GetLastSlot() != slot_count) {
+        ThrowSnapshotCorrupted();
+    }
+    for (size_t i = 0; i < segment_count; ++i) {
+        if (loaded.segments[i]->GetFirstSlot() != (i == 0 ? 0 : loaded.segments[i - 1]->GetLastSlot())) {
+            ThrowSnapshotCorrupted();
+        }
+    }
+    try {
+        CheckMergePolicy(loaded.merge_policy);
+    } catch (const std::invalid_argument &) {
+        ThrowSnapshotCorrupted();
+    }
+
+    for (TermId term_id = 0; term_id < loaded.document_freqs.size(); ++term_id) {
+        if (loaded.document_freqs[term_id] != 0) {
+            server->term_statistics_.GetMutable(term_id).AddDocuments(loaded.document_freqs[term_id]);
+        }
+    }
+    server->collection_statistics_.AddDocuments(loaded.document_count);
+    server->merge_policy_ = loaded.merge_policy;
+
+    for (int slot = 0; slot < slot_count; ++slot) {
+        const auto &document = loaded.documents[slot];
+        server->documents_.GetMutable(slot) = document;
+        if (!document.is_removed) {
+            server->document_slots_.GetMutable(document.id) = slot;
+        }
+    }
+    loaded.document_texts.resize(slot_count);
+    server->document_texts_.reserve(slot_count);
+    for (const std::string_view text : loaded.document_texts) {
+        server->document_texts_.push_back(server->document_text_arena_.Add(text));
+    }
+    size_t term = 0;
+    for (size_t i = 0; i < loaded.word_freq_ids.size(); ++i) {
+        const int document_id = loaded.word_freq_ids[i];
+        if (server->document_slots_.Find(document_id) == nullptr) {
+            ThrowSnapshotCorrupted();
+        }
+        server->document_ids_.emplace_hint(server->document_ids_.end(), document_id);
+        auto &word_freqs = server->document_to_word_freqs_.try_emplace(
+                server->document_to_word_freqs_.end(), document_id)->second;
+        for (const size_t end = term + loaded.word_counts[i]; term < end; ++term) {
+            word_freqs.emplace_hint(word_freqs.end(), loaded.term_ids[term], loaded.term_freqs[term]);
+        }
+    }
+
+    server->write_segment_ = std::move(*loaded.segments.back());
+    loaded.segments.pop_back();
+    server->segments_.assign(loaded.segments.begin(), loaded.segments.end());
+    server->segment_removed_counts_ = std::move(loaded.segment_removed_counts);
+    server->write_segment_removed_count_ = loaded.write_segment_removed_count;
+    server->UpdateSegments();
+    server->Publish();
+    return server;
+}
+
+SearchServer::QueryBatch::QueryBatch(const SearchServer &search_server, const std::vector<std::string> &raw_queries,
+                                     DocumentStatus status, size_t top_count)
+        : guard_(search_server.reclaimer_.Pin()),
+          index_version_(*search_server.published_version_.load()),
+          version_{{}, {}, index_version_.collection_statistics, index_version_.documents},
+          status_(status),
+          top_count_(top_count) {
+    const IndexVersion &version = index_version_;
+
+    // Каждое различное слово пакета ищется в словаре один раз
+    std::unordered_map<std::string_view, std::optional<TermId>> word_ids;
+    std::vector<std::pair<std::vector<TermId>, std::vector<TermId>>> query_term_ids(raw_queries.size());
+    for (size_t i = 0; i < raw_queries.size(); ++i) {
+        auto &[plus_words, minus_words] = query_term_ids[i];
+        for (const std::string_view word : SplitIntoWords(raw_queries[i])) {
+            const auto query_word = ParseQueryWord(search_server.tokenizer_, word);
+            if (query_word.is_stop) {
+                continue;
+            }
+            auto [it, inserted] = word_ids.try_emplace(query_word.data);
+            if (inserted) {
+                it->second = version.lexicon.Find(query_word.data);
+            }
+            if (it->second) {
+                (query_word.is_minus ? minus_words : plus_words).push_back(*it->second);
+            }
+        }
+    }
+
+    std::vector<TermId> term_ids;
+    for (const auto &[word, term_id] : word_ids) {
+        if (term_id) {
+            term_ids.push_back(*term_id);
+        }
+    }
+    std::sort(term_ids.begin(), term_ids.end());
+    const auto to_batch_id = [&term_ids](TermId term_id) {
+        return static_cast<TermId>(std::lower_bound(term_ids.begin(), term_ids.end(), term_id) - term_ids.begin());
+    };
+
+    queries_.reserve(raw_queries.size());
+    costs_.reserve(raw_queries.size());
+    for (auto &[plus_words, minus_words] : query_term_ids) {
+        auto &query = queries_.emplace_back();
+        for (auto [words, batch_words] : {std::pair{&plus_words, &query.plus_words},
+                                          std::pair{&minus_words, &query.minus_words}}) {
+            std::sort(words->begin(), words->end());
+            words->erase(std::unique(words->begin(), words->end()), words->end());
+            batch_words->reserve(words->size());
+            for (const TermId term_id : *words) {
+                batch_words->push_back(to_batch_id(term_id));
+            }
+        }
+    }
+
+    version_.term_statistics.reserve(term_ids.size());
+    for (const TermId term_id : term_ids) {
+        version_.term_statistics.push_back(version.term_statistics[term_id]);
+    }
+    for (const auto &query : queries_) {
+        size_t cost = 1;
+        for (const auto *words : {&query.plus_words, &query.minus_words}) {
+            for (const TermId term_id : *words) {
+                cost += version_.term_statistics[term_id].document_freq;
+            }
+        }
+        costs_.push_back(cost);
+    }
+
+    for (const auto &segment : version.segments) {
+        auto batch_segment = std::make_unique<Segment>();
+        batch_segment->segment = segment.get();
+        batch_segment->postings.reserve(term_ids.size());
+        for (const TermId term_id : term_ids) {
+            batch_segment->postings.push_back(&segment->GetPostings(term_id));
+        }
+        version_.segments.push_back(std::move(batch_segment));
+    }
+}
+
+size_t SearchServer::QueryBatch::size() const {
+    return queries_.size();
+}
+
+size_t SearchServer::QueryBatch::GetQueryCost(size_t query) const {
+    return costs_[query];
+}
 
-    return result;
+std::vector<Document> SearchServer::QueryBatch::FindTopDocuments(size_t query) const {
+    return SearchServer::FindTopDocuments(std::execution::seq, version_, queries_[query],
+                                          [status = status_](int, DocumentStatus document_status, int) {
+                                              return document_status == status;
+                                          },
+                                          top_count_);
 }
 
-// Подсчитывает TF-IDF
-double SearchServer::ComputeWordInverseDocumentFreq(const std::string_view &word) const {
-    return log(GetDocumentCount() * 1.0 / word_to_document_freqs_.at(word).size());
+size_t SearchServer::QueryBatch::FindTopDocuments(size_t query, Document *documents) const {
+    TopDocuments top_documents(documents, top_count_);
+    AddTopDocuments(version_, queries_[query], [status = status_](int, DocumentStatus document_status, int) {
+        return document_status == status;
+    }, top_documents);
+    const size_t count = top_documents.SortBuffer();
+    ResolveDocumentIds(version_, documents, documents + count);
+    return count;
 }
 
 // Выводит результаты в консоль
@@ -2,64 +2,126 @@
 
 #include <map>
 #include <algorithm>
+#include <atomic>
+#include <exception>
 #include <execution>
+#include <future>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
 #include <set>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
+#include "allocation_options.h"
+#include "collection_statistics.h"
 #include "document.h"
+#include "duplicate_index.h"
+#include "epoch_reclaimer.h"
+#include "index_segment.h"
+#include "index_snapshot.h"
 #include "string_processing.h"
-#include "concurrent_map.h"
-
-inline static constexpr double EPSILON = 1e-6;
-
+#include "lexicon.h"
+#include "text_arena.h"
+#include "max_score.h"
+#include "merge_policy.h"
+#include "posting_list.h"
+#include "query_cache.h"
+#include "score_accumulator.h"
+#include "tokenizer.h"
+#include "top_documents.h"
+#include "versioned_array.h"
+
+// Поисковый сервер с одним пишущим потоком и любым числом читающих.
+// Изменяющие индекс методы вызываются из одного потока и после каждого изменения
+// публикуют новую версию индекса. Поиск (FindTopDocuments, MatchDocument, GetDocumentCount)
+// работает с опубликованной версией, не беря блокировок, и может идти параллельно с изменениями.
+// Итерация по ID, GetWordFrequencies и RemoveDuplicates читают данные писателя
+// и с изменениями индекса параллельно не вызываются
 class SearchServer {
 public:
-    // Конструкторы
+    // Конструкторы. allocation_options - откуда берут память тексты и словари документов
     template<typename StringContainer>
-    explicit SearchServer(const StringContainer &stop_words)
-            : stop_words_(MakeUniqueNonEmptyStrings(stop_words)) {
+    explicit SearchServer(const StringContainer &stop_words, const AllocationOptions &allocation_options = {})
+            : tokenizer_(MakeUniqueNonEmptyStrings(stop_words)),
+              owned_memory_resource_(MakeMemoryResource(allocation_options)),
+              memory_resource_(owned_memory_resource_ ? owned_memory_resource_.get()
+                                                      : std::pmr::new_delete_resource()),
+              document_to_word_freqs_(memory_resource_),
+              document_text_arena_(allocation_options.text_chunk_size),
+              document_ids_(memory_resource_) {
         using std::string_literals::operator ""s;
 
-        if (!(std::all_of(stop_words_.begin(), stop_words_.end(), IsValidWord))) {
+        const auto &stop_words_list = tokenizer_.GetStopWords();
+        if (!(std::all_of(stop_words_list.begin(), stop_words_list.end(), IsValidWord))) {
             throw std::invalid_argument("Special character detected"s);
         }
+        Publish();
     }
 
-    explicit SearchServer(const std::string &stop_words_text)
-            : SearchServer(SplitIntoWords(stop_words_text)) {
+    explicit SearchServer(const std::string &stop_words_text, const AllocationOptions &allocation_options = {})
+            : SearchServer(SplitIntoWords(stop_words_text), allocation_options) {
 
     }
 
-    // Добавит документ
+    // Словари документов ссылаются на ресурс памяти сервера, поэтому сервер не копируется
+    // и не перемещается. Load возвращает сервер в std::unique_ptr
+    SearchServer(const SearchServer &) = delete;
+
+    SearchServer &operator=(const SearchServer &) = delete;
+
+    // Добавит документ. При DuplicatePolicy::REJECT бросит DuplicateDocumentError,
+    // если набор слов документа совпадает с набором слов документа в сервере
     void AddDocument(int document_id, std::string_view document,
                      DocumentStatus status, const std::vector<int> &ratings);
 
-    // Удаление документа
+    // Добавит пакет документов с теми же проверками, что и AddDocument.
+    // Если хотя бы один документ пакета некорректен, не добавляется ни один.
+    // При DuplicatePolicy::REJECT копией считается и совпадение с более ранним документом пакета
+    void AddDocuments(const std::vector<NewDocument> &documents);
+
+    // При параллельной политике части пакета разбираются на слова параллельно,
+    // каждая в свой частичный индекс, и затем сливаются в общий индекс в порядке пакета
+    template<typename ExecutionPolicy>
+    void AddDocuments(ExecutionPolicy &&policy, const std::vector<NewDocument> &documents);
+
+    // Удаление документа. Документ только помечается удалённым и перестаёт находиться,
+    // из списков вхождений он уходит при слиянии или переписывании его сегмента
     void RemoveDocument(int document_id);
 
     // Версия метода с возможностью выбора политики выполнения
     template<typename ExecutionPolicy>
     void RemoveDocument(ExecutionPolicy &&policy, int document_id);
 
+    // Удалит пакет документов и опубликует изменения один раз. Отсутствующие ID пропускаются
+    void RemoveDocuments(const std::vector<int> &document_ids);
+
     // Итераторы по id-s документов в сервере
-    std::set<int>::iterator begin() const;
+    std::pmr::set<int>::iterator begin() const;
 
-    std::set<int>::iterator end() const;
+    std::pmr::set<int>::iterator end() const;
 
-    // Поиск документов по запросу
+    // Поиск документов по запросу.
+    // top_count - сколько лучших документов вернуть
     template<typename DocumentPredicate>
     std::vector<Document> FindTopDocuments(const std::string_view &raw_query,
-                                           DocumentPredicate document_predicate) const;
+                                           DocumentPredicate document_predicate,
+                                           size_t top_count = MAX_RESULT_DOCUMENT_COUNT) const;
 
     template<typename DocumentPredicate, typename ExecutionPolicy>
     std::vector<Document> FindTopDocuments(ExecutionPolicy &&policy, const std::string_view &raw_query,
-                                           DocumentPredicate document_predicate) const;
+                                           DocumentPredicate document_predicate,
+                                           size_t top_count = MAX_RESULT_DOCUMENT_COUNT) const;
 
     template<typename ExecutionPolicy>
     std::vector<Document>
-    FindTopDocuments(ExecutionPolicy &&policy, const std::string_view &raw_query, DocumentStatus status) const;
+    FindTopDocuments(ExecutionPolicy &&policy, const std::string_view &raw_query, DocumentStatus status,
+                     size_t top_count = MAX_RESULT_DOCUMENT_COUNT) const;
 
-    std::vector<Document> FindTopDocuments(const std::string_view &raw_query, DocumentStatus status) const;
+    std::vector<Document> FindTopDocuments(const std::string_view &raw_query, DocumentStatus status,
+                                           size_t top_count = MAX_RESULT_DOCUMENT_COUNT) const;
 
     template<typename ExecutionPolicy>
     std::vector<Document> FindTopDocuments(ExecutionPolicy &&policy, const std::string_view &raw_query) const;
@@ -68,6 +130,12 @@ public:
 
     int GetDocumentCount() const;
 
+    // Пакет запросов к одной версии индекса. Запросы разбираются при создании пакета,
+    // слова пакета ищутся в словаре, а их списки вхождений в сегментах и IDF находятся
+    // по одному разу на пакет. Результаты совпадают с FindTopDocuments(raw_query, status, top_count).
+    // Пока пакет жив, версия индекса не освобождается, поэтому пакет не хранят долго
+    class QueryBatch;
+
     // Общие слова и статусы документов по ID
     std::tuple<std::vector<std::string_view>, DocumentStatus>
     MatchDocument(const std::string_view raw_query, int document_id) const;
@@ -80,122 +148,492 @@ public:
     MatchDocument(const std::execution::parallel_policy &,
                   std::string_view raw_query, int document_id) const;
 
-    // Метод получения частот слов по id документа.
-    const std::map<std::string_view, double> &GetWordFrequencies(int document_id) const;
+    // Метод получения частот слов по id документа. Ключи - ID слов в словаре сервера,
+    // словарь документа берёт память из ресурса, выбранного AllocationOptions
+    const std::pmr::map<TermId, double> &GetWordFrequencies(int document_id) const;
+
+    // Заменит правила слияния сегментов индекса. Бросит std::invalid_argument, если они некорректны
+    void SetMergePolicy(const MergePolicy &policy);
+
+    // Дождётся завершения фоновых слияний сегментов и подключит их результат
+    void WaitForMerges();
+
+    // Число неизменяемых сегментов индекса
+    size_t GetSegmentCount() const;
+
+    // Заменит правило добавления копий (duplicate_index.h). При REJECT сервер хранит отпечатки
+    // наборов слов документов: копия находится при добавлении за время, пропорциональное длине
+    // документа, а удалённые документы убираются из отпечатков. Включение строит отпечатки
+    // всех документов сервера, загруженный снимок начинает с ALLOW
+    void SetDuplicatePolicy(DuplicatePolicy policy);
+
+    // Включит кеш результатов поиска по статусу документа (query_cache.h), capacity == 0 - выключит.
+    // Поиск с произвольным предикатом не кешируется. Не вызывается параллельно с поиском.
+    // Бросит std::invalid_argument, если параметры некорректны
+    void SetQueryCacheOptions(const QueryCacheOptions &options);
+
+    // Попадания и промахи кеша результатов, нули, если кеш выключен
+    QueryCacheStatistics GetQueryCacheStatistics() const;
+
+    // Сохранит индекс в двоичный снимок (index_snapshot.h), with_texts - вместе с текстами документов.
+    // Незавершённое фоновое слияние не ждёт: сохраняются его исходные сегменты.
+    // Читает данные писателя. Бросит std::runtime_error, если файл не записан
+    void Save(const std::string &path, bool with_texts = true) const;
+
+    // Загрузит сервер из снимка, сохранённого Save. Секции проверяются и разбираются параллельно.
+    // Бросит std::runtime_error, если файл не читается или повреждён
+    static std::unique_ptr<SearchServer> Load(const std::string &path,
+                                              const AllocationOptions &allocation_options = {});
 
 private:
     // Структура хранения документов
     struct DocumentData {
+        int id;
         int rating;
         DocumentStatus status;
-        std::string data;
+        // Удалённые документы остаются в сегментах до слияния и отсеиваются при поиске
+        bool is_removed;
     };
-    const std::set<std::string> stop_words_; // Множество стоп слов.
-    std::map<std::string_view, std::map<int, double>> word_to_document_freqs_; // Словарь: Слово - ID, IDF
-    std::map<int, std::map<std::string_view, double>> document_to_word_freqs_; // Словарь: ID - Слово, IDF
-    std::map<int, DocumentData> documents_; // Словарь ID добавленных документов и структура данных
-    std::set<int> document_ids_; // все добавленные ID документов
 
-    static bool IsValidWord(std::string_view word);
+    // Версия индекса, которую читают запросы. Версия не меняется после публикации,
+    // с данными писателя и другими версиями она делит всё, что не изменилось
+    struct IndexVersion {
+        Lexicon::Snapshot lexicon;
+        // Неизменяемые сегменты и копия изменяемого сегмента
+        std::vector<std::shared_ptr<const IndexSegment>> segments;
+        VersionedArray<TermStatistics> term_statistics;
+        CollectionStatistics collection_statistics;
+        VersionedArray<DocumentData> documents;
+        VersionedArray<int> document_slots;
+        uint64_t generation; // Поколение набора документов, по нему проверяются результаты кеша
+    };
 
-    bool IsStopWord(std::string_view word) const;
+    const Tokenizer tokenizer_; // Разбор текста и стоп-слова
+    // Ресурс памяти словарей документов, пустой для AllocationStrategy::HEAP
+    std::unique_ptr<std::pmr::memory_resource> owned_memory_resource_;
+    std::pmr::memory_resource *memory_resource_;
+    Lexicon lexicon_; // Словарь всех слов индекса
+    // Списки вхождений хранят не ID документов, а их внутренние номера - индексы в documents_.
+    // Номера выдаются подряд, поэтому накопители релевантности могут быть плоскими массивами.
+    // Слияние, отбросившее удалённые документы, перенумеровывает документы подряд,
+    // поэтому номера и данные по номерам занимают память только под документы в сегментах.
+    // Списки разбиты на сегменты по диапазонам номеров: неизменяемые сегменты по возрастанию
+    // номеров и изменяемый сегмент с новыми документами после них
+    std::vector<std::shared_ptr<const IndexSegment>> segments_;
+    IndexSegment write_segment_;
+    // Число удалённых документов, оставшихся в списках сегментов segments_ (по тем же индексам)
+    // и изменяемого сегмента
+    std::vector<size_t> segment_removed_counts_;
+    size_t write_segment_removed_count_ = 0;
+    MergePolicy merge_policy_;
+    // Фоновое слияние сегментов merge_sources_, не больше одного одновременно.
+    // merge_dropped_count_ - сколько удалённых документов отбросит слияние,
+    // merge_removed_slots_ - признаки удаления документов сливаемого диапазона на его начало
+    std::future<std::shared_ptr<const IndexSegment>> merge_;
+    std::vector<std::shared_ptr<const IndexSegment>> merge_sources_;
+    size_t merge_dropped_count_ = 0;
+    std::vector<bool> merge_removed_slots_;
+    VersionedArray<TermStatistics> term_statistics_; // ID слова - документная частота
+    CollectionStatistics collection_statistics_;
+    std::pmr::map<int, std::pmr::map<TermId, double>> document_to_word_freqs_; // Словарь: ID - ID слова, TF
+    VersionedArray<DocumentData> documents_; // Данные документов по внутренним номерам
+    // Оригиналы текстов по внутренним номерам хранятся подряд в буферах document_text_arena_.
+    // Тексты удалённых документов остаются в буферах, пока их не станет больше половины
+    TextArena document_text_arena_;
+    std::vector<std::string_view> document_texts_;
+    size_t removed_text_size_ = 0;
+    VersionedArray<int> document_slots_; // ID документа - внутренний номер
+    std::pmr::set<int> document_ids_; // все добавленные ID документов
+
+    // Опубликованная версия. Запрос читает её, закрепив эпоху в reclaimer_,
+    // заменённые версии освобождаются, когда их перестают читать
+    std::atomic<const IndexVersion *> published_version_{nullptr};
+    std::shared_ptr<const IndexVersion> published_version_owner_;
+    mutable EpochReclaimer reclaimer_;
+    // Растёт при добавлении и удалении документов. Слияния сегментов результатов поиска не меняют
+    uint64_t generation_ = 0;
+    std::unique_ptr<QueryCache> query_cache_;
+    DuplicatePolicy duplicate_policy_ = DuplicatePolicy::ALLOW;
+    DuplicateIndex duplicate_index_; // Отпечатки наборов слов документов при DuplicatePolicy::REJECT
+
+    // Опубликует текущее состояние индекса. Вызывается в конце изменяющих индекс методов
+    void Publish();
+
+    // Содержимое секций снимка, разобранных независимо друг от друга
+    struct LoadedSnapshot;
+
+    // Разберёт секцию в loaded. segment - номер секции среди секций сегментов
+    static void LoadSnapshotSection(const SnapshotSection &section, size_t segment, LoadedSnapshot &loaded);
 
-    std::vector<std::string_view> SplitIntoWordsNoStop(const std::string_view &text) const;
+    static bool IsValidWord(std::string_view word);
 
     static int ComputeAverageRating(const std::vector<int> &ratings);
 
+    // Пометит документ удалённым, не публикуя изменения. Вернёт false, если документа нет
+    bool MarkRemoved(int document_id);
+
+    // Перепишет тексты живых документов в новые буферы, освободив тексты удалённых
+    void CompactDocumentTexts();
+
+    // Индекс части пакета документов, построенный без обращения к общему индексу
+    struct PartialIndex {
+        size_t first_document = 0; // Номер первого документа части в пакете
+        std::vector<std::string_view> terms; // Локальный номер слова - слово
+        std::vector<TermId> term_ids; // Локальный номер слова - ID в словаре, заполняется при слиянии
+        // Локальный номер слова - номера документов в части и числа вхождений
+        std::vector<std::vector<std::pair<uint32_t, uint32_t>>> postings;
+        // Локальные номера слов и числа вхождений всех документов части подряд,
+        // document_term_ends - конец слов каждого документа в document_terms
+        std::vector<std::pair<uint32_t, uint32_t>> document_terms;
+        std::vector<size_t> document_term_ends;
+        std::vector<double> inv_word_counts; // Обратные длины документов части
+        // ID слов и частоты документов части по возрастанию ID слов, границы документов - document_term_ends
+        std::vector<std::pair<TermId, double>> word_freqs;
+        std::exception_ptr error; // Ошибка разбора документа части
+    };
+
+    // Вернёт ID документа сервера, слова которого - term_ids (по возрастанию, без повторов)
+    std::optional<int> FindDuplicate(const TermSetFingerprint &fingerprint, const std::vector<TermId> &term_ids) const;
+
+    // Отпечатки наборов слов документов пакета по порядку. Бросит DuplicateDocumentError,
+    // если документ - копия документа сервера или более раннего документа пакета.
+    // Вызывается, когда ID слов частей уже найдены, но индекс ещё не изменён
+    std::vector<TermSetFingerprint> CheckNewDocumentDuplicates(const std::vector<NewDocument> &documents,
+                                                               const std::vector<PartialIndex> &parts) const;
+
+    // Бросит std::invalid_argument, если ID документа пакета некорректен,
+    // уже есть в сервере или повторяется в пакете
+    void CheckNewDocumentIds(const std::vector<NewDocument> &documents) const;
+
+    PartialIndex BuildPartialIndex(const std::vector<NewDocument> &documents, size_t first, size_t last) const;
+
+    // Добавит в изменяемый сегмент списки вхождений слов с ID term_id % group_count == group.
+    // Группы не пересекаются по словам и сливаются параллельно
+    void MergePartialPostings(const std::vector<PartialIndex> &parts, int first_slot,
+                              size_t group, size_t group_count);
+
+    // Заполнит частоты слов документов части плоским массивом part.word_freqs. Узлы словарей
+    // документов из него создаёт пишущий поток: ресурс памяти словарей не потокобезопасен
+    static void FillPartialWordFreqs(PartialIndex &part);
+
+    // Перенумерует документы после слияния, начавшегося с first_slot: документы диапазона
+    // слияния, не удалённые к его началу (removed_slots), получают номера подряд, а следующие
+    // за диапазоном сдвигаются вплотную к ним. Данные отброшенных документов освобождаются.
+    // Занимает время, пропорциональное числу документов от first_slot до конца
+    void RenumberSlots(int first_slot, const std::vector<bool> &removed_slots);
+
+    // Подключит завершённое фоновое слияние (при wait - дождавшись его), заморозит
+    // заполненный изменяемый сегмент и начнёт следующее слияние, если есть что сливать,
+    // или переписывание сегмента, в котором накопилось много удалённых документов.
+    // Вызывается только из изменяющих индекс методов
+    void UpdateSegments(bool wait = false);
+
     struct QueryWord {
         std::string_view data;
         bool is_minus;
         bool is_stop;
     };
 
-    QueryWord ParseQueryWord(const std::string_view &text) const;
+    static QueryWord ParseQueryWord(const Tokenizer &tokenizer, const std::string_view &text);
 
+    // Слова запроса, отсутствующие в словаре, в запрос не попадают
     struct Query {
-        std::vector<std::string_view> plus_words;
-        std::vector<std::string_view> minus_words;
+        std::vector<TermId> plus_words;
+        std::vector<TermId> minus_words;
     };
 
-    Query ParseQuery(const std::string_view &text, bool= true) const;
+    // Поиск работает с любой версией индекса, у которой есть словарь lexicon, сегменты segments
+    // по возрастанию номеров документов, статистика term_statistics и collection_statistics,
+    // данные документов documents по номерам и номера документов document_slots по ID:
+    // с IndexVersion и с отображённым в память снимком (MappedSearchServer)
+    template<typename Version>
+    static Query ParseQuery(const Tokenizer &tokenizer, const Version &version, const std::string_view &text,
+                            bool make_uniq = true);
 
-    double ComputeWordInverseDocumentFreq(const std::string_view &word) const;
+    // Оставит в documents top_count лучших документов в порядке выдачи.
+    // Сортируются только попавшие в выдачу документы
+    template<typename ExecutionPolicy>
+    static void SelectTopDocuments(ExecutionPolicy &&policy, std::vector<Document> &documents, size_t top_count);
+
+    // Плюс-слова запроса с курсорами по спискам вхождений сегмента и IDF по статистике версии
+    template<typename Version, typename Segment>
+    static std::vector<ScoredTerm> GetScoredTerms(const Version &version, const Query &query, const Segment &segment);
+
+    template<typename Segment>
+    static std::vector<PostingList::Cursor> GetMinusCursors(const Query &query, const Segment &segment);
+
+    // Сегмент версии, содержащий документ с номером slot
+    template<typename Version>
+    static const auto &GetSegment(const Version &version, int slot);
+
+    // Заменит внутренние номера документов на их ID
+    template<typename Version, typename Iterator>
+    static void ResolveDocumentIds(const Version &version, Iterator first, Iterator last);
+
+    template<typename Version>
+    static std::tuple<std::vector<std::string_view>, DocumentStatus>
+    MatchDocument(const std::execution::sequenced_policy &, const Tokenizer &tokenizer, const Version &version,
+                  std::string_view raw_query, int document_id);
+
+    template<typename Version>
+    static std::tuple<std::vector<std::string_view>, DocumentStatus>
+    MatchDocument(const std::execution::parallel_policy &, const Tokenizer &tokenizer, const Version &version,
+                  std::string_view raw_query, int document_id);
+
+    // Отбор лучших документов без вычисления релевантности всех найденных
+    template<typename Version, typename DocumentPredicate>
+    static std::vector<Document> FindTopDocuments(const std::execution::sequenced_policy &policy,
+                                                  const Version &version,
+                                                  const Query &query,
+                                                  DocumentPredicate document_predicate,
+                                                  size_t top_count);
+
+    // Добавит в top_documents лучшие документы запроса. Вместо ID документов - внутренние номера
+    template<typename Version, typename DocumentPredicate>
+    static void AddTopDocuments(const Version &version, const Query &query, DocumentPredicate document_predicate,
+                                TopDocuments &top_documents);
+
+    // Пространство номеров документов делится на диапазоны, которые обрабатываются параллельно
+    // без общих данных. Лучшие документы диапазонов объединяются в общую выдачу
+    template<typename Version, typename DocumentPredicate>
+    static std::vector<Document> FindTopDocuments(const std::execution::parallel_policy &policy,
+                                                  const Version &version,
+                                                  const Query &query,
+                                                  DocumentPredicate document_predicate,
+                                                  size_t top_count);
+
+    // Накопитель релевантности потока, общий для всех запросов и предикатов
+    static ScoreAccumulator &GetThreadAccumulator();
+
+    // Полный перебор документов с номерами [first_slot, last_slot): релевантность каждого
+    // найденного документа копится в накопителе потока, затем документы добавляются в top_documents.
+    // Вместо ID документов - внутренние номера
+    template<typename Version, typename DocumentPredicate>
+    static void AddTopDocumentsInRange(const Version &version,
+                                       std::vector<ScoredTerm> terms,
+                                       std::vector<PostingList::Cursor> minus_cursors,
+                                       const DocumentPredicate &document_predicate,
+                                       TopDocuments &top_documents,
+                                       int first_slot, int last_slot);
+
+    friend class MappedSearchServer;
+};
 
-    template<typename DocumentPredicate>
-    std::vector<Document> FindAllDocuments(const Query &query,
-                                           DocumentPredicate document_predicate) const;
+class SearchServer::QueryBatch {
+public:
+    // Разбор и поиск слов выполняются в вызывающем потоке.
+    // Бросит std::invalid_argument, если какой-то запрос некорректен
+    QueryBatch(const SearchServer &search_server, const std::vector<std::string> &raw_queries,
+               DocumentStatus status = DocumentStatus::ACTUAL, size_t top_count = MAX_RESULT_DOCUMENT_COUNT);
 
-    template<typename DocumentPredicate>
-    std::vector<Document> FindAllDocuments(const std::execution::sequenced_policy &policy,
-                                           const Query &query,
-                                           DocumentPredicate document_predicate) const;
+    size_t size() const;
 
-    template<typename DocumentPredicate>
-    std::vector<Document> FindAllDocuments(const std::execution::parallel_policy &policy,
-                                           const Query &query,
-                                           DocumentPredicate document_predicate) const;
+    // Оценка трудоёмкости запроса: число вхождений его слов в документы индекса плюс один.
+    // По ней запросы пакета распределяются между потоками
+    size_t GetQueryCost(size_t query) const;
+
+    // Лучшие документы запроса с номером query. Можно вызывать из нескольких потоков
+    std::vector<Document> FindTopDocuments(size_t query) const;
+
+    // Запишет лучшие документы запроса в буфер documents на top_count документов, не выделяя память
+    // под результат. Вернёт число записанных документов
+    size_t FindTopDocuments(size_t query, Document *documents) const;
+
+private:
+    // Сегмент версии со списками вхождений слов пакета по их номерам в пакете
+    struct Segment {
+        const IndexSegment *segment;
+        std::vector<const PostingList *> postings;
+
+        int GetFirstSlot() const {
+            return segment->GetFirstSlot();
+        }
+
+        int GetLastSlot() const {
+            return segment->GetLastSlot();
+        }
+
+        const double *GetInverseWordCounts() const {
+            return segment->GetInverseWordCounts();
+        }
+
+        const PostingList &GetPostings(TermId term_id) const {
+            return *postings[term_id];
+        }
+    };
+
+    // Версия индекса для шаблонов поиска, в которой слова - номера слов в пакете.
+    // Номера выдаются в порядке ID слов, поэтому порядок слов в запросах тот же, что и при разборе ParseQuery
+    struct Version {
+        std::vector<std::unique_ptr<const Segment>> segments;
+        std::vector<TermStatistics> term_statistics;
+        CollectionStatistics collection_statistics;
+        const VersionedArray<DocumentData> &documents;
+    };
+
+    const EpochReclaimer::Guard guard_; // Закрепляется до чтения версии
+    const IndexVersion &index_version_;
+    Version version_;
+    std::vector<Query> queries_;
+    std::vector<size_t> costs_;
+    DocumentStatus status_;
+    size_t top_count_;
 };
 
 template<typename ExecutionPolicy>
-void SearchServer::RemoveDocument(ExecutionPolicy &&policy, int document_id) {
-    if (document_to_word_freqs_.count(document_id) == 0) {
+void SearchServer::AddDocuments(ExecutionPolicy &&policy, const std::vector<NewDocument> &documents) {
+    // Часть меньше MIN_PART_SIZE документов не стоит отдельной задачи
+    static constexpr size_t MIN_PART_SIZE = 256;
+
+    CheckNewDocumentIds(documents);
+    if (documents.empty()) {
         return;
     }
 
-    const auto &word_freq = document_to_word_freqs_.at(document_id);
-    std::vector<std::string_view> words(word_freq.size());
+    size_t part_count = 1;
+    if constexpr (!std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::sequenced_policy>) {
+        const size_t max_part_count = std::max(1u, std::thread::hardware_concurrency());
+        part_count = std::clamp<size_t>(documents.size() / MIN_PART_SIZE, 1, max_part_count);
+    }
+    std::vector<size_t> part_indexes(part_count);
+    std::iota(part_indexes.begin(), part_indexes.end(), 0);
+
+    std::vector<PartialIndex> parts(part_count);
+    std::for_each(policy, part_indexes.begin(), part_indexes.end(),
+                  [this, &documents, &parts, part_count](size_t part) {
+                      parts[part] = BuildPartialIndex(documents, documents.size() * part / part_count,
+                                                      documents.size() * (part + 1) / part_count);
+                  });
+    // Ошибки проверяются до изменения индекса, первой сообщается ошибка в начале пакета
+    for (const auto &part : parts) {
+        if (part.error) {
+            std::rethrow_exception(part.error);
+        }
+    }
+
+    // Копии проверяются по ID слов. Новые слова пакета получают ID в порядке первого появления,
+    // как их выдаст словарь, но добавляются в словарь только после проверки:
+    // отклонённый пакет не оставляет в словаре слов без статистики
+    std::unordered_map<std::string_view, TermId> new_term_ids;
+    std::vector<std::string_view> new_terms;
+    for (auto &part : parts) {
+        part.term_ids.reserve(part.terms.size());
+        for (const std::string_view term : part.terms) {
+            if (const auto term_id = lexicon_.Find(term)) {
+                part.term_ids.push_back(*term_id);
+                continue;
+            }
+            const auto [it, inserted] = new_term_ids.emplace(
+                    term, static_cast<TermId>(lexicon_.size() + new_terms.size()));
+            if (inserted) {
+                new_terms.push_back(term);
+            }
+            part.term_ids.push_back(it->second);
+        }
+    }
+    std::vector<TermSetFingerprint> fingerprints;
+    if (duplicate_policy_ == DuplicatePolicy::REJECT) {
+        fingerprints = CheckNewDocumentDuplicates(documents, parts);
+    }
+    for (const std::string_view term : new_terms) {
+        lexicon_.Intern(term);
+    }
 
-    std::transform(policy, word_freq.begin(), word_freq.end(), words.begin(),
-                   [](const std::pair<const std::string_view, double> &el) {
-                       return el.first;
-                   });
+    // Списки вхождений создаются заранее, чтобы при слиянии только пополнять их.
+    // Общие словарь, статистика и сегмент версионные и меняются только здесь, последовательно
+    for (auto &part : parts) {
+        for (size_t local_term_id = 0; local_term_id < part.terms.size(); ++local_term_id) {
+            const TermId term_id = part.term_ids[local_term_id];
+            write_segment_.AddTerm(term_id);
+            term_statistics_.GetMutable(term_id).AddDocuments(static_cast<int>(part.postings[local_term_id].size()));
+        }
+        for (const double inv_word_count : part.inv_word_counts) {
+            write_segment_.AddDocument(inv_word_count);
+        }
+    }
 
-    std::for_each(policy, words.begin(), words.end(),
-                  [this, document_id](const std::string_view key) {
-                      word_to_document_freqs_.at(key).erase(document_id);
+    const auto first_slot = static_cast<int>(documents_.size());
+    std::for_each(policy, part_indexes.begin(), part_indexes.end(),
+                  [this, &parts, first_slot, part_count](size_t part) {
+                      MergePartialPostings(parts, first_slot, part, part_count);
+                      FillPartialWordFreqs(parts[part]);
                   });
 
-    document_to_word_freqs_.erase(document_id);
-    documents_.erase(document_id);
-    document_ids_.erase(document_id);
+    for (const auto &part : parts) {
+        auto word_freq = part.word_freqs.begin();
+        for (size_t document = 0; document < part.inv_word_counts.size(); ++document) {
+            const auto &new_document = documents[part.first_document + document];
+            const int slot = first_slot + static_cast<int>(part.first_document + document);
+            documents_.GetMutable(slot) = {new_document.id, ComputeAverageRating(new_document.ratings),
+                                           new_document.status, false};
+            document_texts_.push_back(document_text_arena_.Add(new_document.text));
+            document_slots_.GetMutable(new_document.id) = slot;
+            const auto word_freqs_end = part.word_freqs.begin()
+                                        + static_cast<std::ptrdiff_t>(part.document_term_ends[document]);
+            document_to_word_freqs_[new_document.id].insert(word_freq, word_freqs_end);
+            word_freq = word_freqs_end;
+            document_ids_.insert(new_document.id);
+        }
+    }
+    for (size_t document = 0; document < fingerprints.size(); ++document) {
+        duplicate_index_.Insert(fingerprints[document], documents[document].id);
+    }
+    collection_statistics_.AddDocuments(static_cast<int>(documents.size()));
+    ++generation_;
+    UpdateSegments();
+    Publish();
 }
 
-template<typename DocumentPredicate, typename ExecutionPolicy>
-std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy &&policy, const std::string_view &raw_query,
-                                                     DocumentPredicate document_predicate) const {
-    const auto query = ParseQuery(raw_query);
-
-    auto matched_documents = FindAllDocuments(policy, query, document_predicate);
-
-    sort(policy,
-         matched_documents.begin(), matched_documents.end(),
-         [](const Document &lhs, const Document &rhs) {
-             if (std::abs(lhs.relevance - rhs.relevance) < EPSILON) {
-                 return lhs.rating > rhs.rating;
-             } else {
-                 return lhs.relevance > rhs.relevance;
-             }
-         });
-    if (matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT) {
-        matched_documents.resize(MAX_RESULT_DOCUMENT_COUNT);
+template<typename ExecutionPolicy>
+void SearchServer::RemoveDocument(ExecutionPolicy &&, int document_id) {
+    // Удаление не обходит списки вхождений, распараллеливать в нём нечего
+    if (!MarkRemoved(document_id)) {
+        return;
     }
+    UpdateSegments();
+    Publish();
+}
 
-    return matched_documents;
+template<typename DocumentPredicate, typename ExecutionPolicy>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy &&policy, const std::string_view &raw_query,
+                                                     DocumentPredicate document_predicate,
+                                                     size_t top_count) const {
+    // Версия не освобождается, пока жив guard
+    const auto guard = reclaimer_.Pin();
+    const IndexVersion &version = *published_version_.load();
+    const auto query = ParseQuery(tokenizer_, version, raw_query);
+    return FindTopDocuments(policy, version, query, document_predicate, top_count);
 }
 
 template<typename DocumentPredicate>
 std::vector<Document>
-SearchServer::FindTopDocuments(const std::string_view &raw_query, DocumentPredicate document_predicate) const {
-    return FindTopDocuments(std::execution::seq, raw_query, document_predicate);
+SearchServer::FindTopDocuments(const std::string_view &raw_query, DocumentPredicate document_predicate,
+                               size_t top_count) const {
+    return FindTopDocuments(std::execution::seq, raw_query, document_predicate, top_count);
 }
 
 template<typename ExecutionPolicy>
 std::vector<Document>
-SearchServer::FindTopDocuments(ExecutionPolicy &&policy, const std::string_view &raw_query, DocumentStatus status) const {
-    return FindTopDocuments(policy, raw_query,
-                            [&status](int document_id, DocumentStatus new_status, int rating) {
-                                return new_status == status;
-                            });
+SearchServer::FindTopDocuments(ExecutionPolicy &&policy, const std::string_view &raw_query, DocumentStatus status,
+                               size_t top_count) const {
+    const auto guard = reclaimer_.Pin();
+    const IndexVersion &version = *published_version_.load();
+    const auto query = ParseQuery(tokenizer_, version, raw_query);
+    const auto document_predicate = [status](int, DocumentStatus new_status, int) {
+        return new_status == status;
+    };
+    if (!query_cache_) {
+        return FindTopDocuments(policy, version, query, document_predicate, top_count);
+    }
+
+    // Запросы, отличающиеся только порядком, повторами или неизвестными индексу словами, дают один ключ
+    QueryCacheKey key{query.plus_words, query.minus_words, status, top_count};
+    if (auto documents = query_cache_->Find(key, version.generation)) {
+        return std::move(*documents);
+    }
+    auto documents = FindTopDocuments(policy, version, query, document_predicate, top_count);
+    query_cache_->Insert(std::move(key), version.generation, documents);
+    return documents;
 }
 
 template<typename ExecutionPolicy>
@@ -203,88 +641,299 @@ std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy &&policy, c
     return FindTopDocuments(policy, raw_query, DocumentStatus::ACTUAL);
 }
 
-template<typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(const std::execution::sequenced_policy &policy,
-                                                     const Query &query,
-                                                     DocumentPredicate document_predicate) const {
-    std::map<int, double> document_to_relevance;
-    for (const std::string_view &word: query.plus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
+template<typename ExecutionPolicy>
+void SearchServer::SelectTopDocuments(ExecutionPolicy &&policy, std::vector<Document> &documents, size_t top_count) {
+    if (documents.size() <= top_count) {
+        std::sort(policy, documents.begin(), documents.end(), IsMoreRelevant);
+        return;
+    }
+    const auto top_end = documents.begin() + static_cast<std::ptrdiff_t>(top_count);
+    std::partial_sort(policy, documents.begin(), top_end, documents.end(), IsMoreRelevant);
+    documents.erase(top_end, documents.end());
+}
+
+template<typename Version>
+SearchServer::Query SearchServer::ParseQuery(const Tokenizer &tokenizer, const Version &version,
+                                             const std::string_view &text, bool make_uniq) {
+    Query result;
+    for (const std::string_view word: SplitIntoWords(text)) {
+        const auto query_word = ParseQueryWord(tokenizer, word);
+        if (query_word.is_stop) {
             continue;
         }
-        const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-        for (const auto [document_id, term_freq]: word_to_document_freqs_.at(word)) {
-            const auto &document_data = documents_.at(document_id);
-            if (document_predicate(document_id, document_data.status, document_data.rating)) {
-                document_to_relevance[document_id] += term_freq * inverse_document_freq;
-            }
+        // Слова, которых нет в индексе, не влияют на результат поиска
+        const auto term_id = version.lexicon.Find(query_word.data);
+        if (!term_id) {
+            continue;
+        }
+        if (query_word.is_minus) {
+            result.minus_words.push_back(*term_id);
+        } else {
+            result.plus_words.push_back(*term_id);
+        }
+    }
+    if (make_uniq) {
+        // Удаление дубликатов из векторов "плюс" и "минус" слов
+        for (auto *word : {&result.plus_words, &result.minus_words}) {
+            std::sort(word->begin(), word->end());
+            auto trash_pos = std::unique(word->begin(), word->end());
+            word->erase(trash_pos, word->end());
         }
     }
 
-    for (const std::string_view &word: query.minus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
+    return result;
+}
+
+template<typename Version, typename Segment>
+std::vector<ScoredTerm> SearchServer::GetScoredTerms(const Version &version, const Query &query,
+                                                     const Segment &segment) {
+    std::vector<ScoredTerm> terms;
+    terms.reserve(query.plus_words.size());
+    for (const TermId term_id: query.plus_words) {
+        const auto &postings = segment.GetPostings(term_id);
+        if (postings.empty()) {
             continue;
         }
-        for (const auto [document_id, _]: word_to_document_freqs_.at(word)) {
-            document_to_relevance.erase(document_id);
+        const double inverse_document_freq =
+                version.collection_statistics.ComputeInverseDocumentFreq(version.term_statistics[term_id]);
+        terms.push_back({PostingList::Cursor(postings, segment.GetInverseWordCounts(), segment.GetFirstSlot()),
+                         inverse_document_freq, postings.GetMaxTermFreq() * inverse_document_freq});
+    }
+    return terms;
+}
+
+template<typename Segment>
+std::vector<PostingList::Cursor> SearchServer::GetMinusCursors(const Query &query, const Segment &segment) {
+    std::vector<PostingList::Cursor> minus_cursors;
+    minus_cursors.reserve(query.minus_words.size());
+    for (const TermId term_id: query.minus_words) {
+        minus_cursors.emplace_back(segment.GetPostings(term_id), nullptr, segment.GetFirstSlot());
+    }
+    return minus_cursors;
+}
+
+template<typename Version>
+const auto &SearchServer::GetSegment(const Version &version, int slot) {
+    const auto &segments = version.segments;
+    const auto it = std::upper_bound(segments.begin(), segments.end(), slot,
+                                     [](int slot, const auto &segment) {
+                                         return slot < segment->GetFirstSlot();
+                                     });
+    return **std::prev(it);
+}
+
+template<typename Version, typename Iterator>
+void SearchServer::ResolveDocumentIds(const Version &version, Iterator first, Iterator last) {
+    for (; first != last; ++first) {
+        first->id = version.documents[first->id].id;
+    }
+}
+
+template<typename Version>
+std::tuple<std::vector<std::string_view>, DocumentStatus>
+SearchServer::MatchDocument(const std::execution::sequenced_policy &, const Tokenizer &tokenizer,
+                            const Version &version, std::string_view raw_query, int document_id) {
+    const Query query = ParseQuery(tokenizer, version, raw_query);
+    const int slot = version.document_slots.at(document_id);
+    const auto status = version.documents[slot].status;
+    const auto &segment = GetSegment(version, slot);
+    const int offset = slot - segment.GetFirstSlot(); // Номер документа в списках сегмента
+
+    for (const TermId term_id : query.minus_words) {
+        if (segment.GetPostings(term_id).Contains(offset)) {
+            return {std::vector<std::string_view>(), status};
         }
     }
 
-    std::vector<Document> matched_documents;
-    for (const auto [document_id, relevance]: document_to_relevance) {
-        matched_documents.push_back(
-                {document_id, relevance, documents_.at(document_id).rating});
+    std::vector<std::string_view> matched_words;
+    for (const TermId term_id : query.plus_words) {
+        if (segment.GetPostings(term_id).Contains(offset)) {
+            matched_words.push_back(version.lexicon.GetTerm(term_id));
+        }
     }
-    return matched_documents;
+    std::sort(matched_words.begin(), matched_words.end());
+
+    return {matched_words, status};
 }
 
-template<typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(const Query &query,
-                                                     DocumentPredicate document_predicate) const {
-    return FindAllDocuments(std::execution::seq, query, document_predicate);
+template<typename Version>
+std::tuple<std::vector<std::string_view>, DocumentStatus>
+SearchServer::MatchDocument(const std::execution::parallel_policy &, const Tokenizer &tokenizer,
+                            const Version &version, std::string_view raw_query, int document_id) {
+    const auto query = ParseQuery(tokenizer, version, raw_query, false);
+    const int slot = version.document_slots.at(document_id);
+    const auto status = version.documents[slot].status;
+    const auto &segment = GetSegment(version, slot);
+    const auto word_checker =
+            [&segment, offset = slot - segment.GetFirstSlot()](TermId term_id) {
+                return segment.GetPostings(term_id).Contains(offset);
+            };
+
+    if (std::any_of(std::execution::par, query.minus_words.begin(), query.minus_words.end(), word_checker)) {
+        return {std::vector<std::string_view>(), status};
+    }
+
+    std::vector<TermId> matched_ids(query.plus_words.size());
+    auto ids_end = std::copy_if(
+            std::execution::par,
+            query.plus_words.begin(), query.plus_words.end(),
+            matched_ids.begin(),
+            word_checker
+    );
+
+    std::sort(matched_ids.begin(), ids_end);
+    ids_end = std::unique(matched_ids.begin(), ids_end);
+
+    std::vector<std::string_view> matched_words;
+    matched_words.reserve(ids_end - matched_ids.begin());
+    for (auto it = matched_ids.begin(); it != ids_end; ++it) {
+        matched_words.push_back(version.lexicon.GetTerm(*it));
+    }
+    std::sort(matched_words.begin(), matched_words.end());
+
+    return {matched_words, status};
 }
 
-template<typename DocumentPredicate>
-std::vector<Document>
-SearchServer::FindAllDocuments(const std::execution::parallel_policy &policy,
-                               const Query &query,
-                               DocumentPredicate document_predicate) const {
-    ConcurrentMap<int, double> document_to_relevance(16);
-
-    std::for_each(policy,
-                  query.minus_words.begin(), query.minus_words.end(),
-                  [this, &document_to_relevance](std::string_view word) {
-                      if (word_to_document_freqs_.count(word)) {
-                          for (const auto [document_id, _]: word_to_document_freqs_.at(word)) {
-                              document_to_relevance.Erase(document_id);
-                          }
-                      }
-                  });
+template<typename Version, typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(const std::execution::sequenced_policy &,
+                                                     const Version &version,
+                                                     const Query &query,
+                                                     DocumentPredicate document_predicate,
+                                                     size_t top_count) {
+    TopDocuments top_documents(top_count);
+    AddTopDocuments(version, query, document_predicate, top_documents);
+    auto matched_documents = top_documents.Extract();
+    ResolveDocumentIds(version, matched_documents.begin(), matched_documents.end());
+    return matched_documents;
+}
 
-    std::for_each(policy,
-                  query.plus_words.begin(), query.plus_words.end(),
-                  [this, &document_predicate, &document_to_relevance](std::string_view word) {
-                      if (word_to_document_freqs_.count(word)) {
-                          const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-                          for (const auto [document_id, term_freq]: word_to_document_freqs_.at(word)) {
-                              const auto &document_data = documents_.at(document_id);
-                              if (document_predicate(document_id, document_data.status, document_data.rating)) {
-                                  document_to_relevance[document_id].ref_to_value += term_freq * inverse_document_freq;
-                              }
+template<typename Version, typename DocumentPredicate>
+void SearchServer::AddTopDocuments(const Version &version, const Query &query,
+                                   DocumentPredicate document_predicate, TopDocuments &top_documents) {
+    const auto document_filter = [&version, &document_predicate](int slot) -> std::optional<int> {
+        const auto &document_data = version.documents[slot];
+        if (document_data.is_removed
+            || !document_predicate(document_data.id, document_data.status, document_data.rating)) {
+            return std::nullopt;
+        }
+        return document_data.rating;
+    };
+
+    // Сегменты обходятся с общим набором лучших документов: порог, набранный
+    // в одном сегменте, отсекает документы следующих
+    for (const auto &segment_ptr: version.segments) {
+        const auto &segment = *segment_ptr;
+        auto terms = GetScoredTerms(version, query, segment);
+        if (terms.empty()) {
+            continue;
+        }
+        auto minus_cursors = GetMinusCursors(query, segment);
+
+        // Если в выдачу попадут все найденные документы сегмента, отсекать нечего
+        size_t posting_count = 0;
+        for (const TermId term_id: query.plus_words) {
+            posting_count += segment.GetPostings(term_id).size();
+        }
+        if (posting_count <= top_documents.GetCapacity()) {
+            AddTopDocumentsInRange(version, std::move(terms), std::move(minus_cursors), document_predicate,
+                                   top_documents, segment.GetFirstSlot(), segment.GetLastSlot());
+            continue;
+        }
+        CollectTopDocuments(terms, minus_cursors, document_filter, top_documents);
+    }
+}
+
+template<typename Version, typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(const std::execution::parallel_policy &policy,
+                                                     const Version &version,
+                                                     const Query &query,
+                                                     DocumentPredicate document_predicate,
+                                                     size_t top_count) {
+    // Диапазон меньше MIN_RANGE_SIZE документов не стоит отдельной задачи
+    static constexpr int MIN_RANGE_SIZE = 4096;
+    const auto slot_count = static_cast<int>(version.documents.size());
+    const int max_range_count = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    const int range_count = std::clamp(slot_count / MIN_RANGE_SIZE, 1, max_range_count);
+
+    std::vector<std::vector<Document>> range_documents(range_count);
+    std::vector<int> ranges(range_count);
+    std::iota(ranges.begin(), ranges.end(), 0);
+    std::for_each(policy, ranges.begin(), ranges.end(),
+                  [&](int range) {
+                      const auto first_slot = static_cast<int>(int64_t{slot_count} * range / range_count);
+                      const auto last_slot = static_cast<int>(int64_t{slot_count} * (range + 1) / range_count);
+                      // Диапазон может задевать несколько сегментов
+                      TopDocuments top_documents(top_count);
+                      for (const auto &segment: version.segments) {
+                          const int first = std::max(first_slot, segment->GetFirstSlot());
+                          const int last = std::min(last_slot, segment->GetLastSlot());
+                          if (first >= last) {
+                              continue;
                           }
+                          AddTopDocumentsInRange(version, GetScoredTerms(version, query, *segment),
+                                                 GetMinusCursors(query, *segment), document_predicate,
+                                                 top_documents, first, last);
                       }
+                      range_documents[range] = top_documents.Extract();
                   });
 
-    std::map<int, double> document_to_relevance_reduced = document_to_relevance.BuildOrdinaryMap();
     std::vector<Document> matched_documents;
-    matched_documents.reserve(document_to_relevance_reduced.size());
-
-    for (const auto [document_id, relevance]: document_to_relevance_reduced) {
-        matched_documents.emplace_back(document_id, relevance, documents_.at(document_id).rating);
+    for (const auto &documents: range_documents) {
+        matched_documents.insert(matched_documents.end(), documents.begin(), documents.end());
     }
+    SelectTopDocuments(std::execution::seq, matched_documents, top_count);
+    ResolveDocumentIds(version, matched_documents.begin(), matched_documents.end());
     return matched_documents;
 }
 
+template<typename Version, typename DocumentPredicate>
+void SearchServer::AddTopDocumentsInRange(const Version &version,
+                                          std::vector<ScoredTerm> terms,
+                                          std::vector<PostingList::Cursor> minus_cursors,
+                                          const DocumentPredicate &document_predicate,
+                                          TopDocuments &top_documents,
+                                          int first_slot, int last_slot) {
+    // Накопитель переиспользуется между запросами одного потока. Состояние запроса, прерванного
+    // исключением из предиката, сбрасывает Reset следующего
+    auto &accumulator = GetThreadAccumulator();
+    accumulator.Reset(first_slot, last_slot - first_slot);
+
+    for (auto &term: terms) {
+        auto &cursor = term.cursor;
+        for (cursor.NextGeq(first_slot); !cursor.IsEnd() && cursor.GetDocumentId() < last_slot; cursor.Next()) {
+            const int slot = cursor.GetDocumentId();
+            if (!accumulator.IsTouched(slot)) {
+                const auto &document_data = version.documents[slot];
+                if (!document_data.is_removed
+                    && document_predicate(document_data.id, document_data.status, document_data.rating)) {
+                    accumulator.Accept(slot);
+                } else {
+                    accumulator.Reject(slot);
+                }
+            }
+            if (!accumulator.IsRejected(slot)) {
+                accumulator.Add(slot, cursor.GetTermFreq() * term.inverse_document_freq);
+            }
+        }
+    }
+
+    for (auto &cursor: minus_cursors) {
+        for (cursor.NextGeq(first_slot); !cursor.IsEnd() && cursor.GetDocumentId() < last_slot; cursor.Next()) {
+            const int slot = cursor.GetDocumentId();
+            if (accumulator.IsTouched(slot)) {
+                accumulator.Reject(slot);
+            }
+        }
+    }
+
+    for (const int slot: accumulator.GetTouched()) {
+        if (!accumulator.IsRejected(slot)) {
+            top_documents.Add({slot, accumulator.GetRelevance(slot), version.documents[slot].rating});
+        }
+    }
+    accumulator.Clear();
+}
+
 // Выводит результаты в консоль
 void PrintMatchDocumentResult(int document_id, const std::vector<std::string> &words, DocumentStatus status);
 
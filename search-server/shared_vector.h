@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Вектор с дешёвым копированием. Копии делят буфер значений, и каждая помнит свой размер.
+// Буфер помнит, сколько первых значений видят его копии: дописывание в конец и изменение
+// значений за этой границей выполняются в общем буфере без его перевыделения, поэтому
+// сделанные ранее копии не меняются и их можно читать из других потоков.
+// Остальные изменения общего буфера сначала копируют его, дописывание - с запасом,
+// чтобы копия выполнялась O(1) раз в среднем на значение.
+// Как и у VersionedArray, копировать, изменять и уничтожать копии должен один поток,
+// а остальные потоки только читают их
+template<typename T>
+class SharedVector {
+public:
+    SharedVector() = default;
+
+    SharedVector(const SharedVector &other);
+
+    SharedVector(SharedVector &&other) noexcept;
+
+    SharedVector &operator=(const SharedVector &other);
+
+    SharedVector &operator=(SharedVector &&other) noexcept;
+
+    size_t size() const;
+
+    bool empty() const;
+
+    const T *data() const;
+
+    const T *begin() const;
+
+    const T *end() const;
+
+    const T &operator[](size_t index) const;
+
+    const T &back() const;
+
+    // Вернёт значение для изменения
+    T &GetMutable(size_t index);
+
+    // Вернёт значения начиная с first для изменения
+    T *GetMutableData(size_t first);
+
+    void push_back(const T &value);
+
+    // Вставит count копий value перед значением с индексом position
+    void insert(size_t position, size_t count, const T &value);
+
+    // Удалит значения с индексами [first, last)
+    void erase(size_t first, size_t last);
+
+    template<typename Iterator>
+    void assign(Iterator first, Iterator last);
+
+    // Допишет значения [first, last) в конец
+    template<typename Iterator>
+    void append(Iterator first, Iterator last);
+
+    void clear();
+
+    void shrink_to_fit();
+
+private:
+    struct Buffer {
+        std::vector<T> values;
+        // Сколько первых значений видят копии вектора. Их нельзя менять на месте
+        size_t shared_size = 0;
+    };
+
+    std::shared_ptr<Buffer> buffer_;
+    size_t size_ = 0;
+
+    // Запомнит, что текущие значения видит ещё одна копия
+    void Share() const;
+
+    // Подготовит буфер к изменению значений с индексами от first и к росту до new_size значений
+    std::vector<T> &MakeWritable(size_t first, size_t new_size);
+};
+
+template<typename T>
+SharedVector<T>::SharedVector(const SharedVector &other)
+        : buffer_(other.buffer_), size_(other.size_) {
+    Share();
+}
+
+template<typename T>
+SharedVector<T>::SharedVector(SharedVector &&other) noexcept
+        : buffer_(std::move(other.buffer_)), size_(other.size_) {
+    other.size_ = 0;
+}
+
+template<typename T>
+SharedVector<T> &SharedVector<T>::operator=(const SharedVector &other) {
+    buffer_ = other.buffer_;
+    size_ = other.size_;
+    Share();
+    return *this;
+}
+
+template<typename T>
+SharedVector<T> &SharedVector<T>::operator=(SharedVector &&other) noexcept {
+    buffer_ = std::move(other.buffer_);
+    size_ = other.size_;
+    other.size_ = 0;
+    return *this;
+}
+
+template<typename T>
+size_t SharedVector<T>::size() const {
+    return size_;
+}
+
+template<typename T>
+bool SharedVector<T>::empty() const {
+    return size_ == 0;
+}
+
+template<typename T>
+const T *SharedVector<T>::data() const {
+    return buffer_ ? buffer_->values.data() : nullptr;
+}
+
+template<typename T>
+const T *SharedVector<T>::begin() const {
+    return data();
+}
+
+template<typename T>
+const T *SharedVector<T>::end() const {
+    return data() + size_;
+}
+
+template<typename T>
+const T &SharedVector<T>::operator[](size_t index) const {
+    return buffer_->values[index];
+}
+
+template<typename T>
+const T &SharedVector<T>::back() const {
+    return buffer_->values[size_ - 1];
+}
+
+template<typename T>
+T &SharedVector<T>::GetMutable(size_t index) {
+    return MakeWritable(index, size_)[index];
+}
+
+template<typename T>
+T *SharedVector<T>::GetMutableData(size_t first) {
+    return MakeWritable(first, size_).data() + first;
+}
+
+template<typename T>
+void SharedVector<T>::push_back(const T &value) {
+    MakeWritable(size_, size_ + 1).push_back(value);
+    ++size_;
+}
+
+template<typename T>
+void SharedVector<T>::insert(size_t position, size_t count, const T &value) {
+    auto &values = MakeWritable(position, size_ + count);
+    values.insert(values.begin() + static_cast<std::ptrdiff_t>(position), count, value);
+    size_ = values.size();
+}
+
+template<typename T>
+void SharedVector<T>::erase(size_t first, size_t last) {
+    auto &values = MakeWritable(first, size_);
+    values.erase(values.begin() + static_cast<std::ptrdiff_t>(first),
+                 values.begin() + static_cast<std::ptrdiff_t>(last));
+    size_ = values.size();
+}
+
+template<typename T>
+template<typename Iterator>
+void SharedVector<T>::assign(Iterator first, Iterator last) {
+    buffer_ = std::make_shared<Buffer>();
+    buffer_->values.assign(first, last);
+    size_ = buffer_->values.size();
+}
+
+template<typename T>
+template<typename Iterator>
+void SharedVector<T>::append(Iterator first, Iterator last) {
+    auto &values = MakeWritable(size_, size_ + static_cast<size_t>(std::distance(first, last)));
+    values.insert(values.end(), first, last);
+    size_ = values.size();
+}
+
+template<typename T>
+void SharedVector<T>::clear() {
+    if (buffer_ && buffer_.use_count() == 1) {
+        buffer_->values.clear();
+        buffer_->shared_size = 0;
+    } else {
+        buffer_.reset();
+    }
+    size_ = 0;
+}
+
+template<typename T>
+void SharedVector<T>::shrink_to_fit() {
+    if (!buffer_ || buffer_->values.capacity() == size_) {
+        return;
+    }
+    if (buffer_.use_count() == 1) {
+        buffer_->values.resize(size_);
+        buffer_->values.shrink_to_fit();
+    } else {
+        auto buffer = std::make_shared<Buffer>();
+        buffer->values.assign(begin(), end());
+        buffer_ = std::move(buffer);
+    }
+}
+
+template<typename T>
+void SharedVector<T>::Share() const {
+    if (buffer_) {
+        buffer_->shared_size = std::max(buffer_->shared_size, size_);
+    }
+}
+
+template<typename T>
+std::vector<T> &SharedVector<T>::MakeWritable(size_t first, size_t new_size) {
+    if (!buffer_) {
+        buffer_ = std::make_shared<Buffer>();
+    } else if (buffer_.use_count() == 1) {
+        // Копий нет: значения за size_ остались от удалённой копии
+        buffer_->values.resize(size_);
+        buffer_->shared_size = 0;
+    } else if (first < buffer_->shared_size || buffer_->values.size() != size_
+               || new_size > buffer_->values.capacity()) {
+        auto buffer = std::make_shared<Buffer>();
+        buffer->values.reserve(std::max(new_size, 2 * size_));
+        buffer->values.assign(begin(), end());
+        buffer_ = std::move(buffer);
+    }
+    return buffer_->values;
+}
@@ -0,0 +1,110 @@
+#include "tests.h"
+
+#include <execution>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../search_server.h"
+#include "reference_search.h"
+
+namespace {
+
+constexpr int VOCABULARY_SIZE = 200;
+
+struct Corpus {
+    std::vector<std::string> texts;
+    std::vector<NewDocument> documents;
+};
+
+Corpus GenerateCorpus(std::mt19937 &generator, int first_id, int document_count) {
+    Corpus corpus;
+    corpus.texts.reserve(document_count);
+    for (int i = 0; i < document_count; ++i) {
+        corpus.texts.push_back(GenerateText(generator, VOCABULARY_SIZE, 1, 12));
+    }
+    for (int i = 0; i < document_count; ++i) {
+        const int id = first_id + i;
+        const auto status = id % 5 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL;
+        corpus.documents.push_back({id, corpus.texts[i], status, {id, 1}});
+    }
+    return corpus;
+}
+
+void AssertSameServers(const SearchServer &actual, const SearchServer &expected, std::mt19937 &generator) {
+    ASSERT_EQUAL(actual.GetDocumentCount(), expected.GetDocumentCount());
+    ASSERT_EQUAL(std::vector<int>(actual.begin(), actual.end()), std::vector<int>(expected.begin(), expected.end()));
+    for (int i = 0; i < 100; ++i) {
+        const std::string query = GenerateReferenceQuery(generator, VOCABULARY_SIZE, 0.2);
+        for (const auto status : {DocumentStatus::ACTUAL, DocumentStatus::BANNED}) {
+            AssertSameDocuments(actual.FindTopDocuments(query, status), expected.FindTopDocuments(query, status),
+                                query);
+        }
+    }
+    for (const int document_id : expected) {
+        if (document_id % 37 == 0) {
+            const auto query = "w0 w1 w2 w3 w4 w5 w6 w7 w8 w9 -w" + std::to_string(document_id % VOCABULARY_SIZE);
+            ASSERT(actual.MatchDocument(query, document_id) == expected.MatchDocument(query, document_id));
+        }
+    }
+}
+
+// Пакет, разобранный частями в нескольких потоках, даёт тот же индекс, что добавление по одному документу
+void TestAddDocumentsMatchesSingleAdds() {
+    std::mt19937 generator(11);
+    const auto first = GenerateCorpus(generator, 0, 1500);
+    const auto second = GenerateCorpus(generator, 1500, 700);
+
+    SearchServer expected(std::string("w1"));
+    for (const auto *corpus : {&first, &second}) {
+        for (const auto &document : corpus->documents) {
+            expected.AddDocument(document.id, document.text, document.status, document.ratings);
+        }
+    }
+
+    SearchServer sequential(std::string("w1"));
+    sequential.AddDocuments(std::execution::seq, first.documents);
+    sequential.AddDocuments(std::execution::seq, second.documents);
+    AssertSameServers(sequential, expected, generator);
+
+    SearchServer parallel(std::string("w1"));
+    parallel.AddDocuments(std::execution::par, first.documents);
+    parallel.AddDocuments(second.documents);
+    AssertSameServers(parallel, expected, generator);
+}
+
+// Некорректный пакет отвергается целиком
+void TestInvalidBatchLeavesServerUnchanged() {
+    std::mt19937 generator(12);
+    const auto corpus = GenerateCorpus(generator, 0, 600);
+    SearchServer server(std::string("w1"));
+    SearchServer expected(std::string("w1"));
+    server.AddDocuments(corpus.documents);
+    expected.AddDocuments(corpus.documents);
+
+    auto batch = GenerateCorpus(generator, 600, 600);
+    batch.documents[500].text = "bad\x01word";
+    ASSERT_THROWS(server.AddDocuments(std::execution::par, batch.documents), std::invalid_argument);
+    batch.documents[500].text = batch.texts[500];
+
+    batch.documents[300].id = 5;
+    ASSERT_THROWS(server.AddDocuments(batch.documents), std::invalid_argument);
+    batch.documents[300].id = 1000;
+    ASSERT_THROWS(server.AddDocuments(batch.documents), std::invalid_argument);
+    batch.documents[300].id = -1;
+    ASSERT_THROWS(server.AddDocuments(std::execution::par, batch.documents), std::invalid_argument);
+    AssertSameServers(server, expected, generator);
+
+    batch.documents[300].id = 900;
+    server.AddDocuments(std::execution::par, batch.documents);
+    expected.AddDocuments(batch.documents);
+    AssertSameServers(server, expected, generator);
+}
+
+} // namespace
+
+void RunAddDocumentsTests(TestRunner &tr) {
+    RUN_TEST(tr, TestAddDocumentsMatchesSingleAdds);
+    RUN_TEST(tr, TestInvalidBatchLeavesServerUnchanged);
+}
@@ -0,0 +1,78 @@
+#include "tests.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../bit_packing.h"
+
+namespace {
+
+// Упаковка и распаковка блока восстанавливают числа при любой разрядности,
+// в том числе крайних 0 и 32 и числах, занимающих ровно bits бит
+void TestPackBlockRoundTrip() {
+    std::mt19937 generator(9);
+    for (uint32_t bits = 0; bits <= 32; ++bits) {
+        const uint32_t max_value = bits == 32 ? UINT32_MAX : (uint32_t{1} << bits) - 1;
+        std::vector<uint32_t> values(PACKED_BLOCK_SIZE);
+        for (size_t i = 0; i < values.size(); ++i) {
+            values[i] = i % 5 == 0 ? max_value : std::uniform_int_distribution<uint32_t>(0, max_value)(generator);
+        }
+        const std::string hint = "bits = " + std::to_string(bits);
+        AssertEqual(GetRequiredBits(values.data()), bits, hint);
+
+        // Слово за блоком не должно быть затёрто
+        std::vector<uint32_t> packed(GetPackedWordCount(bits) + 1, 0xDEADBEEF);
+        PackBlock(values.data(), bits, packed.data());
+        AssertEqual(packed.back(), 0xDEADBEEFu, hint);
+        std::vector<uint32_t> unpacked(PACKED_BLOCK_SIZE, 1);
+        UnpackBlock(packed.data(), bits, unpacked.data());
+        AssertEqual(unpacked, values, hint);
+    }
+}
+
+void TestRequiredBits() {
+    std::vector<uint32_t> values(PACKED_BLOCK_SIZE, 0);
+    ASSERT_EQUAL(GetRequiredBits(values.data()), 0u);
+    values.back() = 1;
+    ASSERT_EQUAL(GetRequiredBits(values.data()), 1u);
+    values.front() = 256;
+    ASSERT_EQUAL(GetRequiredBits(values.data()), 9u);
+    values[64] = UINT32_MAX;
+    ASSERT_EQUAL(GetRequiredBits(values.data()), 32u);
+}
+
+// Разности с шагом 4 восстанавливают возрастающие ID, включая повторы и скачки до UINT32_MAX
+void TestDeltasRoundTrip() {
+    std::mt19937 generator(10);
+    for (const uint32_t base : {0u, 17u, 1u << 30}) {
+        std::vector<uint32_t> values(PACKED_BLOCK_SIZE);
+        uint32_t value = base;
+        for (auto &element : values) {
+            value += std::uniform_int_distribution<uint32_t>(0, 1000)(generator);
+            element = value;
+        }
+        values.back() = UINT32_MAX;
+        std::vector<uint32_t> deltas(PACKED_BLOCK_SIZE);
+        EncodeDeltas(values.data(), base, deltas.data());
+        for (size_t i = 4; i < deltas.size(); ++i) {
+            ASSERT_EQUAL(deltas[i], values[i] - values[i - 4]);
+        }
+
+        const uint32_t bits = GetRequiredBits(deltas.data());
+        std::vector<uint32_t> packed(GetPackedWordCount(bits));
+        PackBlock(deltas.data(), bits, packed.data());
+        std::vector<uint32_t> decoded(PACKED_BLOCK_SIZE);
+        UnpackBlock(packed.data(), bits, decoded.data());
+        DecodeDeltas(decoded.data(), base);
+        ASSERT_EQUAL(decoded, values);
+    }
+}
+
+} // namespace
+
+void RunBitPackingTests(TestRunner &tr) {
+    RUN_TEST(tr, TestPackBlockRoundTrip);
+    RUN_TEST(tr, TestRequiredBits);
+    RUN_TEST(tr, TestDeltasRoundTrip);
+}
@@ -0,0 +1,66 @@
+#include "tests.h"
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../collection_statistics.h"
+#include "../search_server.h"
+#include "reference_search.h"
+
+namespace {
+
+void TestTermStatisticsFollowDocumentFreq() {
+    TermStatistics term;
+    term.AddDocuments(4);
+    ASSERT_EQUAL(term.document_freq, 4);
+    ASSERT(std::abs(term.log_document_freq - std::log(4.0)) < EPSILON);
+    term.AddDocuments(-4);
+    ASSERT_EQUAL(term.document_freq, 0);
+    ASSERT_EQUAL(term.log_document_freq, 0.0);
+
+    CollectionStatistics collection;
+    collection.AddDocuments(10);
+    term.AddDocuments(2);
+    ASSERT(std::abs(collection.ComputeInverseDocumentFreq(term) - std::log(5.0)) < EPSILON);
+}
+
+// IDF, поддерживаемый при добавлениях, удалениях и замене документов, совпадает с пересчитанным заново
+void TestInverseDocumentFreqAfterUpdates() {
+    constexpr int vocabulary_size = 60;
+    std::mt19937 generator(8);
+    SearchServer server(std::string("w3"));
+    ReferenceSearch reference("w3");
+    std::vector<int> ids;
+    for (int step = 0; step < 3000; ++step) {
+        const bool remove = !ids.empty() && std::uniform_int_distribution(0, 2)(generator) == 0;
+        if (remove) {
+            const auto position = std::uniform_int_distribution<size_t>(0, ids.size() - 1)(generator);
+            server.RemoveDocument(ids[position]);
+            reference.RemoveDocument(ids[position]);
+            ids[position] = ids.back();
+            ids.pop_back();
+        } else {
+            const std::string text = GenerateText(generator, vocabulary_size, 1, 8);
+            server.AddDocument(step, text, DocumentStatus::ACTUAL, {step});
+            reference.AddDocument(step, text, DocumentStatus::ACTUAL, step);
+            ids.push_back(step);
+        }
+        if (step % 100 == 99) {
+            ASSERT_EQUAL(server.GetDocumentCount(), static_cast<int>(ids.size()));
+            for (int i = 0; i < 10; ++i) {
+                const std::string query = GenerateReferenceQuery(generator, vocabulary_size, 0.1);
+                AssertSameDocuments(server.FindTopDocuments(query, DocumentStatus::ACTUAL, 20),
+                                    reference.FindTopDocuments(query, DocumentStatus::ACTUAL, 20), query);
+            }
+        }
+    }
+}
+
+} // namespace
+
+void RunCollectionStatisticsTests(TestRunner &tr) {
+    RUN_TEST(tr, TestTermStatisticsFollowDocumentFreq);
+    RUN_TEST(tr, TestInverseDocumentFreqAfterUpdates);
+}
@@ -0,0 +1,99 @@
+#include "tests.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../epoch_reclaimer.h"
+#include "../search_server.h"
+
+namespace {
+
+// Снятый с публикации объект живёт, пока его может читать закрепивший эпоху читатель
+void TestEpochReclaimerKeepsPinnedObjects() {
+    EpochReclaimer reclaimer;
+    auto first = std::make_shared<int>(1);
+    const std::weak_ptr<int> first_observer = first;
+    {
+        const auto guard = reclaimer.Pin();
+        reclaimer.Retire(std::move(first));
+        reclaimer.Collect();
+        ASSERT(!first_observer.expired());
+    }
+    reclaimer.Collect();
+    ASSERT(first_observer.expired());
+
+    // Закреплённая после снятия эпоха не держит объект
+    auto second = std::make_shared<int>(2);
+    const std::weak_ptr<int> second_observer = second;
+    reclaimer.Retire(std::move(second));
+    const auto guard = reclaimer.Pin();
+    reclaimer.Collect();
+    ASSERT(second_observer.expired());
+}
+
+// Каждый поиск во время добавлений и удалений видит целую версию индекса:
+// документы - непрерывный диапазон ID, и версии не откатываются назад
+void TestSearchDuringUpdates() {
+    constexpr int document_count = 3000;
+    constexpr int window = 500;
+    SearchServer server(std::string("and"));
+    server.SetMergePolicy({64, 2, 0.25});
+    std::atomic<bool> is_done = false;
+    std::atomic<int> failures = 0;
+
+    const auto read = [&] {
+        int last_id = -1;
+        while (!is_done.load()) {
+            auto documents = server.FindTopDocuments("common", [](int, DocumentStatus, int) {
+                return true;
+            }, document_count);
+            if (documents.empty()) {
+                continue;
+            }
+            std::vector<int> ids;
+            for (const auto &document : documents) {
+                ids.push_back(document.id);
+            }
+            std::sort(ids.begin(), ids.end());
+            const bool is_contiguous = ids.back() - ids.front() + 1 == static_cast<int>(ids.size());
+            if (!is_contiguous || ids.back() < last_id || static_cast<int>(ids.size()) > window + 1) {
+                ++failures;
+            }
+            last_id = ids.back();
+        }
+    };
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 2; ++i) {
+        readers.emplace_back(read);
+    }
+
+    for (int id = 0; id < document_count; ++id) {
+        server.AddDocument(id, "common and word" + std::to_string(id % 7), DocumentStatus::ACTUAL, {id});
+        if (id >= window) {
+            server.RemoveDocument(id - window);
+        }
+        if (id % 100 == 0) {
+            std::this_thread::yield();
+        }
+    }
+    is_done = true;
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    ASSERT_EQUAL(failures.load(), 0);
+    ASSERT_EQUAL(server.GetDocumentCount(), window);
+    ASSERT_EQUAL(server.FindTopDocuments("common", [](int, DocumentStatus, int) {
+        return true;
+    }, document_count).size(), static_cast<size_t>(window));
+}
+
+} // namespace
+
+void RunConcurrentReadsTests(TestRunner &tr) {
+    RUN_TEST(tr, TestEpochReclaimerKeepsPinnedObjects);
+    RUN_TEST(tr, TestSearchDuringUpdates);
+}
@@ -0,0 +1,131 @@
+#include "tests.h"
+
+#include <execution>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../duplicate_index.h"
+#include "../process_queries.h"
+#include "../search_server.h"
+
+namespace {
+
+std::vector<int> GetIds(const SearchServer &server) {
+    return {server.begin(), server.end()};
+}
+
+NewDocument MakeDocument(int id, std::string_view text) {
+    return {id, text, DocumentStatus::ACTUAL, {1}};
+}
+
+// Документы с одинаковым отпечатком различаются предикатом сравнения слов
+void TestDuplicateIndex() {
+    DuplicateIndex index;
+    const auto fingerprint = ComputeTermSetFingerprint(std::vector<TermId>{1, 2});
+    ASSERT(!index.Find(fingerprint, [](int) {
+        return true;
+    }));
+    index.Insert(fingerprint, 5);
+    index.Insert(fingerprint, 7);
+    ASSERT_EQUAL(index.size(), 2u);
+    ASSERT(index.Find(fingerprint, [](int document_id) {
+        return document_id == 7;
+    }) == 7);
+    index.Erase(fingerprint, 7);
+    ASSERT(!index.Find(fingerprint, [](int document_id) {
+        return document_id == 7;
+    }));
+    index.Clear();
+    ASSERT_EQUAL(index.size(), 0u);
+}
+
+// При REJECT копия набора слов не добавляется и сообщает ID оригинала,
+// а после удаления оригинала документ с тем же набором слов добавляется
+void TestRejectDuplicateDocument() {
+    SearchServer server(std::string("and"));
+    server.AddDocument(1, "cat and dog", DocumentStatus::ACTUAL, {1});
+    server.AddDocument(2, "dog dog parrot", DocumentStatus::ACTUAL, {1});
+    server.SetDuplicatePolicy(DuplicatePolicy::REJECT);
+
+    try {
+        server.AddDocument(3, "dog and cat cat", DocumentStatus::ACTUAL, {1});
+        ASSERT(false);
+    } catch (const DuplicateDocumentError &error) {
+        ASSERT_EQUAL(error.GetDocumentId(), 3);
+        ASSERT_EQUAL(error.GetOriginalId(), 1);
+    }
+    ASSERT_EQUAL(server.GetDocumentCount(), 2);
+
+    server.AddDocument(3, "cat dog bird", DocumentStatus::ACTUAL, {1});
+    server.RemoveDocument(1);
+    server.AddDocument(4, "cat dog", DocumentStatus::ACTUAL, {1});
+    ASSERT_THROWS(server.AddDocument(5, "parrot dog", DocumentStatus::ACTUAL, {1}), DuplicateDocumentError);
+    ASSERT_EQUAL(GetIds(server), std::vector<int>({2, 3, 4}));
+
+    server.SetDuplicatePolicy(DuplicatePolicy::ALLOW);
+    server.AddDocument(5, "dog cat", DocumentStatus::ACTUAL, {1});
+    ASSERT_EQUAL(server.GetDocumentCount(), 4);
+}
+
+// Пакет отклоняется целиком, если документ копирует документ сервера или более ранний документ пакета
+void TestRejectDuplicateBatch() {
+    SearchServer server(std::string("and"));
+    server.AddDocument(1, "cat and dog", DocumentStatus::ACTUAL, {1});
+    server.SetDuplicatePolicy(DuplicatePolicy::REJECT);
+
+    try {
+        server.AddDocuments(
+                {MakeDocument(2, "white cat"), MakeDocument(3, "fluffy dog"), MakeDocument(4, "cat white")});
+        ASSERT(false);
+    } catch (const DuplicateDocumentError &error) {
+        ASSERT_EQUAL(error.GetDocumentId(), 4);
+        ASSERT_EQUAL(error.GetOriginalId(), 2);
+    }
+    ASSERT_THROWS(server.AddDocuments(std::execution::par,
+                                      {MakeDocument(2, "white cat"), MakeDocument(3, "dog cat")}),
+                  DuplicateDocumentError);
+    ASSERT_EQUAL(GetIds(server), std::vector<int>({1}));
+
+    server.AddDocuments({MakeDocument(2, "white cat"), MakeDocument(3, "fluffy dog")});
+    ASSERT_EQUAL(GetIds(server), std::vector<int>({1, 2, 3}));
+    ASSERT_THROWS(server.AddDocument(4, "cat white", DocumentStatus::ACTUAL, {1}), DuplicateDocumentError);
+}
+
+// Отклонённый пакет с новыми словами не оставляет в словаре слов без статистики:
+// следующий документ и поиск по словам пакета работают как прежде
+void TestRejectedBatchKeepsLexiconConsistent() {
+    SearchServer server(std::string("and"));
+    server.AddDocument(1, "quick brown fox", DocumentStatus::ACTUAL, {1});
+    server.SetDuplicatePolicy(DuplicatePolicy::REJECT);
+
+    std::string long_text;
+    for (int i = 0; i < 5000; ++i) {
+        long_text += "w" + std::to_string(i) + ' ';
+    }
+    long_text += "end";
+    ASSERT_THROWS(server.AddDocuments({MakeDocument(2, long_text), MakeDocument(3, "fox brown quick")}),
+                  DuplicateDocumentError);
+    ASSERT_EQUAL(server.GetDocumentCount(), 1);
+
+    server.AddDocument(4, "lazy dog", DocumentStatus::ACTUAL, {1});
+    for (const std::string query : {"w100 fox", "w4999 -w1 dog", "end"}) {
+        ASSERT_EQUAL(ProcessQueries(server, {query}).front().size(), server.FindTopDocuments(query).size());
+    }
+    ASSERT_EQUAL(server.FindTopDocuments("w100 fox").size(), 1u);
+    ASSERT(server.FindTopDocuments("w100").empty());
+
+    // Слова пакета получают ID, когда пакет всё же добавляется
+    server.AddDocuments({MakeDocument(2, long_text), MakeDocument(3, "w100 fox")});
+    ASSERT_EQUAL(server.FindTopDocuments("w100").size(), 2u);
+    ASSERT_EQUAL(server.FindTopDocuments("end").size(), 1u);
+}
+
+} // namespace
+
+void RunDuplicatePolicyTests(TestRunner &tr) {
+    RUN_TEST(tr, TestDuplicateIndex);
+    RUN_TEST(tr, TestRejectDuplicateDocument);
+    RUN_TEST(tr, TestRejectDuplicateBatch);
+    RUN_TEST(tr, TestRejectedBatchKeepsLexiconConsistent);
+}
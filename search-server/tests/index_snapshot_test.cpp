@@ -0,0 +1,184 @@
+#include "tests.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../index_snapshot.h"
+#include "../search_server.h"
+#include "reference_search.h"
+
+namespace {
+
+std::string GetTemporaryPath(const std::string &name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// Обратит биты байта в середине данных последней секции снимка
+void CorruptLastSection(const std::string &path) {
+    std::string data;
+    const auto sections = ReadSnapshotFile(path, data);
+    const auto &section = sections.back().data;
+    const auto position = static_cast<std::streamoff>(section.data() - data.data() + section.size() / 2);
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekg(position);
+    char byte = 0;
+    file.read(&byte, 1);
+    byte = static_cast<char>(~byte);
+    file.seekp(position);
+    file.write(&byte, 1);
+}
+
+// Значения читаются в порядке записи с выравниванием, чтение за концом данных - ошибка
+void TestSnapshotWriterReader() {
+    SnapshotWriter writer;
+    writer.Write<uint8_t>(7);
+    writer.Write<double>(0.5);
+    writer.WriteArray(std::vector<int>{1, 2, 3});
+    writer.WriteString("text");
+    writer.Write<uint32_t>(42);
+
+    SnapshotReader reader(writer.GetData());
+    ASSERT_EQUAL(reader.Read<uint8_t>(), 7);
+    ASSERT_EQUAL(reader.Read<double>(), 0.5);
+    std::vector<int> values;
+    reader.ReadArray(values);
+    ASSERT_EQUAL(values, std::vector<int>({1, 2, 3}));
+    ASSERT_EQUAL(reader.ReadString(), "text");
+    ASSERT_EQUAL(reader.Read<uint32_t>(), 42u);
+    ASSERT(reader.IsEnd());
+    ASSERT_THROWS(reader.Read<uint32_t>(), std::runtime_error);
+
+    // Размер массива больше оставшихся данных
+    SnapshotWriter broken;
+    broken.Write<uint64_t>(1000);
+    SnapshotReader broken_reader(broken.GetData());
+    ASSERT_THROWS(broken_reader.ReadArrayView<int>(), std::runtime_error);
+}
+
+// Секции файла читаются как записаны, а испорченная секция не проходит проверку суммы
+void TestSnapshotFileChecksums() {
+    const std::string path = GetTemporaryPath("index_snapshot_test_sections.idx");
+    std::vector<std::pair<SnapshotSectionType, std::string>> sections;
+    sections.emplace_back(SnapshotSectionType::STOP_WORDS, "stop words");
+    sections.emplace_back(SnapshotSectionType::LEXICON, std::string(100, 'x'));
+    WriteSnapshotFile(path, sections);
+
+    std::string data;
+    auto read_sections = ReadSnapshotFile(path, data);
+    ASSERT_EQUAL(read_sections.size(), 2u);
+    ASSERT(read_sections[0].type == SnapshotSectionType::STOP_WORDS);
+    ASSERT_EQUAL(read_sections[0].data, "stop words");
+    ASSERT_EQUAL(read_sections[1].data, sections[1].second);
+    for (const auto &section : read_sections) {
+        CheckSnapshotSection(section);
+    }
+
+    CorruptLastSection(path);
+    read_sections = ReadSnapshotFile(path, data);
+    CheckSnapshotSection(read_sections[0]);
+    ASSERT_THROWS(CheckSnapshotSection(read_sections[1]), std::runtime_error);
+
+    // Файл, который не является снимком
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "not a snapshot";
+    ASSERT_THROWS(ReadSnapshotFile(path, data), std::runtime_error);
+    std::filesystem::remove(path);
+    ASSERT_THROWS(ReadSnapshotFile(path, data), std::runtime_error);
+}
+
+// Загруженный сервер отвечает как сохранённый и продолжает принимать изменения как он
+void TestSaveLoadRoundTrip() {
+    constexpr int vocabulary_size = 120;
+    std::mt19937 generator(15);
+    SearchServer server(std::string("w0 w1"));
+    server.SetMergePolicy({32, 3, 0.25});
+    ReferenceSearch reference("w0 w1");
+    const DocumentStatus statuses[] = {DocumentStatus::ACTUAL, DocumentStatus::IRRELEVANT, DocumentStatus::BANNED};
+    const auto add_document = [&](SearchServer &target, int id) {
+        const std::string text = GenerateText(generator, vocabulary_size, 1, 12);
+        // Различные рейтинги однозначно упорядочивают документы с равной релевантностью
+        target.AddDocument(id, text, statuses[id % 3], {id, id + 1});
+        reference.AddDocument(id, text, statuses[id % 3], id);
+    };
+    for (int id = 0; id < 1500; ++id) {
+        add_document(server, id);
+        if (id % 5 == 4) {
+            server.RemoveDocument(id - 3);
+            reference.RemoveDocument(id - 3);
+        }
+    }
+
+    const std::string path = GetTemporaryPath("index_snapshot_test_server.idx");
+    for (const bool with_texts : {true, false}) {
+        server.Save(path, with_texts);
+        const auto loaded = SearchServer::Load(path);
+        ASSERT_EQUAL(loaded->GetDocumentCount(), server.GetDocumentCount());
+        ASSERT_EQUAL(loaded->GetSegmentCount(), server.GetSegmentCount());
+        ASSERT(std::equal(loaded->begin(), loaded->end(), server.begin(), server.end()));
+        for (int i = 0; i < 50; ++i) {
+            const std::string query = GenerateReferenceQuery(generator, vocabulary_size, 0.2);
+            for (const auto status : statuses) {
+                AssertSameDocuments(loaded->FindTopDocuments(query, status), server.FindTopDocuments(query, status),
+                                    query);
+            }
+        }
+        for (const int document_id : server) {
+            ASSERT(loaded->GetWordFrequencies(document_id) == server.GetWordFrequencies(document_id));
+            if (document_id % 50 == 0) {
+                ASSERT(loaded->MatchDocument("w2 w3 w4 -w5", document_id)
+                       == server.MatchDocument("w2 w3 w4 -w5", document_id));
+            }
+        }
+    }
+
+    // Загруженный сервер продолжает пополняться и сливать сегменты
+    auto loaded = SearchServer::Load(path);
+    for (int id = 1500; id < 2000; ++id) {
+        add_document(*loaded, id);
+    }
+    loaded->RemoveDocuments({0, 5, 1999});
+    reference.RemoveDocument(0);
+    reference.RemoveDocument(5);
+    reference.RemoveDocument(1999);
+    loaded->WaitForMerges();
+    for (int i = 0; i < 50; ++i) {
+        const std::string query = GenerateReferenceQuery(generator, vocabulary_size, 0.2);
+        AssertSameDocuments(loaded->FindTopDocuments(query),
+                            reference.FindTopDocuments(query, DocumentStatus::ACTUAL, MAX_RESULT_DOCUMENT_COUNT),
+                            query);
+    }
+    std::filesystem::remove(path);
+}
+
+// Повреждённый, обрезанный или отсутствующий снимок не загружается
+void TestLoadRejectsBrokenSnapshot() {
+    SearchServer server(std::string("and"));
+    server.AddDocument(1, "white cat and fancy collar", DocumentStatus::ACTUAL, {1});
+    server.AddDocument(2, "fluffy cat fluffy tail", DocumentStatus::ACTUAL, {2});
+    const std::string path = GetTemporaryPath("index_snapshot_test_broken.idx");
+
+    server.Save(path);
+    CorruptLastSection(path);
+    ASSERT_THROWS(SearchServer::Load(path), std::runtime_error);
+
+    server.Save(path);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) / 2);
+    ASSERT_THROWS(SearchServer::Load(path), std::runtime_error);
+
+    std::filesystem::remove(path);
+    ASSERT_THROWS(SearchServer::Load(path), std::runtime_error);
+}
+
+} // namespace
+
+void RunIndexSnapshotTests(TestRunner &tr) {
+    RUN_TEST(tr, TestSnapshotWriterReader);
+    RUN_TEST(tr, TestSnapshotFileChecksums);
+    RUN_TEST(tr, TestSaveLoadRoundTrip);
+    RUN_TEST(tr, TestLoadRejectsBrokenSnapshot);
+}
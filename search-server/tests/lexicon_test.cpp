@@ -0,0 +1,71 @@
+#include "tests.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "../lexicon.h"
+
+namespace {
+
+void TestLexiconInternsTermsOnce() {
+    Lexicon lexicon;
+    const TermId cat = lexicon.Intern("cat");
+    const TermId dog = lexicon.Intern("dog");
+    ASSERT_EQUAL(cat, 0u);
+    ASSERT_EQUAL(dog, 1u);
+    ASSERT_EQUAL(lexicon.Intern(std::string("cat")), cat);
+    ASSERT_EQUAL(lexicon.size(), 2u);
+    ASSERT_EQUAL(lexicon.GetTerm(dog), "dog");
+    ASSERT(lexicon.Find("dog") == dog);
+    ASSERT(!lexicon.Find("bird"));
+}
+
+// Снимок не видит слов, добавленных после него, и переживает перестроение хеш-таблицы словаря
+void TestLexiconSnapshotIsIsolated() {
+    Lexicon lexicon;
+    lexicon.Intern("first");
+    const Lexicon::Snapshot snapshot = lexicon.GetSnapshot();
+    for (int i = 0; i < 1000; ++i) {
+        lexicon.Intern("term" + std::to_string(i));
+    }
+    ASSERT_EQUAL(snapshot.size(), 1u);
+    ASSERT(snapshot.Find("first") == TermId{0});
+    ASSERT(!snapshot.Find("term10"));
+
+    const Lexicon::Snapshot &current = lexicon.GetSnapshot();
+    ASSERT_EQUAL(current.size(), 1001u);
+    for (int i = 0; i < 1000; ++i) {
+        const auto term_id = current.Find("term" + std::to_string(i));
+        ASSERT(term_id == static_cast<TermId>(i + 1));
+        ASSERT_EQUAL(current.GetTerm(*term_id), "term" + std::to_string(i));
+    }
+}
+
+// Отображённый словарь находит те же слова по тем же ID, а ID за пределами словаря - ошибка снимка
+void TestMappedLexiconMatchesLexicon() {
+    Lexicon lexicon;
+    for (int i = 0; i < 300; ++i) {
+        lexicon.Intern("term" + std::to_string(i * 7 % 300));
+    }
+    SnapshotWriter writer;
+    lexicon.Save(writer);
+    SnapshotReader reader(writer.GetData());
+    const auto mapped = MappedLexicon::Load(reader);
+
+    ASSERT_EQUAL(mapped.size(), lexicon.size());
+    for (TermId term_id = 0; term_id < lexicon.size(); ++term_id) {
+        ASSERT_EQUAL(mapped.GetTerm(term_id), lexicon.GetTerm(term_id));
+        ASSERT(mapped.Find(lexicon.GetTerm(term_id)) == term_id);
+    }
+    ASSERT(!mapped.Find("term300"));
+    ASSERT(!mapped.Find(""));
+    ASSERT_THROWS(mapped.GetTerm(static_cast<TermId>(lexicon.size())), std::runtime_error);
+}
+
+} // namespace
+
+void RunLexiconTests(TestRunner &tr) {
+    RUN_TEST(tr, TestLexiconInternsTermsOnce);
+    RUN_TEST(tr, TestLexiconSnapshotIsIsolated);
+    RUN_TEST(tr, TestMappedLexiconMatchesLexicon);
+}
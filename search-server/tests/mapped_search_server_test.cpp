@@ -0,0 +1,82 @@
+#include "tests.h"
+
+#include <execution>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "../mapped_search_server.h"
+#include "../search_server.h"
+#include "reference_search.h"
+
+namespace {
+
+std::string GetTemporaryPath(const std::string &name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// Отображённый снимок отвечает на запросы так же, как сохранивший его сервер
+void TestMappedServerMatchesSaved() {
+    constexpr int vocabulary_size = 120;
+    std::mt19937 generator(16);
+    SearchServer server(std::string("w0 w1"));
+    server.SetMergePolicy({32, 3, 0.25});
+    const DocumentStatus statuses[] = {DocumentStatus::ACTUAL, DocumentStatus::IRRELEVANT, DocumentStatus::BANNED};
+    for (int id = 0; id < 1500; ++id) {
+        server.AddDocument(id, GenerateText(generator, vocabulary_size, 1, 12), statuses[id % 3], {id});
+        if (id % 5 == 4) {
+            server.RemoveDocument(id - 3);
+        }
+    }
+    const std::string path = GetTemporaryPath("mapped_search_server_test.idx");
+    server.Save(path, false);
+
+    {
+        const MappedSearchServer mapped(path);
+        ASSERT_EQUAL(mapped.GetDocumentCount(), server.GetDocumentCount());
+        const auto even_rating = [](int, DocumentStatus, int rating) {
+            return rating % 2 == 0;
+        };
+        for (int i = 0; i < 50; ++i) {
+            const std::string query = GenerateReferenceQuery(generator, vocabulary_size, 0.2);
+            for (const auto status : statuses) {
+                AssertSameDocuments(mapped.FindTopDocuments(query, status), server.FindTopDocuments(query, status),
+                                    query);
+            }
+            AssertSameDocuments(mapped.FindTopDocuments(std::execution::par, query),
+                                server.FindTopDocuments(query), query);
+            AssertSameDocuments(mapped.FindTopDocuments(query, even_rating),
+                                server.FindTopDocuments(query, even_rating), query);
+        }
+        for (const int document_id : server) {
+            if (document_id % 20 == 0) {
+                const std::string query = "w2 w3 w4 w5 -w6";
+                ASSERT(mapped.MatchDocument(query, document_id) == server.MatchDocument(query, document_id));
+                ASSERT(mapped.MatchDocument(std::execution::par, query, document_id)
+                       == server.MatchDocument(query, document_id));
+            }
+        }
+        // Удалённый и отсутствующий документы
+        ASSERT_THROWS(mapped.MatchDocument("w2", 1), std::out_of_range);
+        ASSERT_THROWS(mapped.MatchDocument("w2", 5000), std::out_of_range);
+    }
+    std::filesystem::remove(path);
+}
+
+// Файл, который не является снимком или отсутствует, не открывается
+void TestMappedServerRejectsForeignFile() {
+    const std::string path = GetTemporaryPath("mapped_search_server_test_foreign.idx");
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << std::string(256, 'x');
+    ASSERT_THROWS(MappedSearchServer{path}, std::runtime_error);
+    std::filesystem::remove(path);
+    ASSERT_THROWS(MappedSearchServer{path}, std::runtime_error);
+}
+
+} // namespace
+
+void RunMappedSearchServerTests(TestRunner &tr) {
+    RUN_TEST(tr, TestMappedServerMatchesSaved);
+    RUN_TEST(tr, TestMappedServerRejectsForeignFile);
+}
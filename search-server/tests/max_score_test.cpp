@@ -0,0 +1,39 @@
+#include "tests.h"
+
+#include <random>
+#include <string>
+
+#include "../search_server.h"
+#include "reference_search.h"
+
+namespace {
+
+constexpr int VOCABULARY_SIZE = 300;
+
+// Отбор MaxScore с отсечением по границам слов даёт ту же выдачу, что полный перебор
+void TestMaxScoreMatchesExhaustiveScoring() {
+    std::mt19937 generator(4);
+    SearchServer server(std::string("w1 w2"));
+    ReferenceSearch reference("w1 w2");
+    for (int id = 0; id < 3000; ++id) {
+        const std::string text = GenerateText(generator, VOCABULARY_SIZE, 3, 20);
+        const auto status = id % 10 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL;
+        server.AddDocument(id, text, status, {id});
+        reference.AddDocument(id, text, status, id);
+    }
+    for (int i = 0; i < 300; ++i) {
+        const std::string query = GenerateReferenceQuery(generator, VOCABULARY_SIZE, 0.2);
+        for (const size_t top_count : {1u, 5u, 40u}) {
+            for (const auto status : {DocumentStatus::ACTUAL, DocumentStatus::BANNED}) {
+                AssertSameDocuments(server.FindTopDocuments(query, status, top_count),
+                                    reference.FindTopDocuments(query, status, top_count), query);
+            }
+        }
+    }
+}
+
+} // namespace
+
+void RunMaxScoreTests(TestRunner &tr) {
+    RUN_TEST(tr, TestMaxScoreMatchesExhaustiveScoring);
+}
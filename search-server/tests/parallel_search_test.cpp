@@ -0,0 +1,42 @@
+#include "tests.h"
+
+#include <execution>
+#include <random>
+#include <string>
+
+#include "../search_server.h"
+#include "reference_search.h"
+
+namespace {
+
+constexpr int VOCABULARY_SIZE = 400;
+
+// Поиск по диапазонам документов в нескольких потоках даёт ту же выдачу, что последовательный
+// и полный перебор. Документов больше, чем в одном диапазоне, и они лежат в нескольких сегментах
+void TestParallelSearchMatchesSequential() {
+    std::mt19937 generator(7);
+    SearchServer server(std::string("w0"));
+    ReferenceSearch reference("w0");
+    for (int id = 0; id < 10000; ++id) {
+        const std::string text = GenerateText(generator, VOCABULARY_SIZE, 3, 15);
+        const auto status = id % 7 == 0 ? DocumentStatus::IRRELEVANT : DocumentStatus::ACTUAL;
+        server.AddDocument(id, text, status, {id});
+        reference.AddDocument(id, text, status, id);
+    }
+    for (int i = 0; i < 200; ++i) {
+        const std::string query = GenerateReferenceQuery(generator, VOCABULARY_SIZE, 0.2);
+        for (const size_t top_count : {1u, 5u, 30u}) {
+            const auto expected = reference.FindTopDocuments(query, DocumentStatus::ACTUAL, top_count);
+            AssertSameDocuments(server.FindTopDocuments(std::execution::par, query, DocumentStatus::ACTUAL,
+                                                        top_count), expected, query);
+            AssertSameDocuments(server.FindTopDocuments(std::execution::seq, query, DocumentStatus::ACTUAL,
+                                                        top_count), expected, query);
+        }
+    }
+}
+
+} // namespace
+
+void RunParallelSearchTests(TestRunner &tr) {
+    RUN_TEST(tr, TestParallelSearchMatchesSequential);
+}
@@ -0,0 +1,155 @@
+#include "tests.h"
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "../posting_list.h"
+
+namespace {
+
+std::vector<int> CollectDocumentIds(const PostingList &postings) {
+    std::vector<int> document_ids;
+    for (PostingList::Cursor cursor(postings); !cursor.IsEnd(); cursor.Next()) {
+        document_ids.push_back(cursor.GetDocumentId());
+    }
+    return document_ids;
+}
+
+void TestPostingListCursor() {
+    PostingList postings;
+    ASSERT(postings.empty());
+    for (const int document_id : {1, 3, 5, 7, 9}) {
+        postings.Add(document_id, static_cast<uint32_t>(document_id), 0.1);
+    }
+    ASSERT_EQUAL(postings.size(), 5u);
+    ASSERT_EQUAL(CollectDocumentIds(postings), std::vector<int>({1, 3, 5, 7, 9}));
+
+    PostingList::Cursor cursor(postings);
+    cursor.NextGeq(4);
+    ASSERT_EQUAL(cursor.GetDocumentId(), 5);
+    ASSERT_EQUAL(cursor.GetTermCount(), 5u);
+    cursor.NextGeq(10);
+    ASSERT(cursor.IsEnd());
+}
+
+void TestPostingListTermFreqs() {
+    PostingList postings;
+    const double inverse_word_counts[] = {0.5, 0.25, 0.125};
+    postings.Add(0, 2, 1.0);
+    postings.Add(2, 4, 0.5);
+    // Номера в списке отсчитываются от 10
+    PostingList::Cursor cursor(postings, inverse_word_counts, 10);
+    ASSERT_EQUAL(cursor.GetDocumentId(), 10);
+    ASSERT_EQUAL(cursor.GetTermFreq(), 1.0);
+    cursor.NextGeq(11);
+    ASSERT_EQUAL(cursor.GetDocumentId(), 12);
+    ASSERT_EQUAL(cursor.GetTermFreq(), 0.5);
+    ASSERT_EQUAL(postings.GetMaxTermFreq(), 1.0);
+}
+
+// Документы с пропусками номеров на нескольких блоках сверяются с std::set
+void TestPostingListMatchesSet() {
+    std::mt19937 generator(42);
+    PostingList postings;
+    std::set<int> expected;
+    for (int document_id = 0; document_id <= 3000; ++document_id) {
+        if (std::uniform_int_distribution(0, 2)(generator) == 0) {
+            postings.Add(document_id, static_cast<uint32_t>(document_id % 7 + 1), 0.5);
+            expected.insert(document_id);
+        }
+    }
+    ASSERT_EQUAL(postings.size(), expected.size());
+    ASSERT_EQUAL(CollectDocumentIds(postings), std::vector<int>(expected.begin(), expected.end()));
+    for (int document_id = 0; document_id <= 3000; document_id += 13) {
+        ASSERT_EQUAL(postings.Contains(document_id), expected.count(document_id) == 1);
+    }
+    ASSERT(!postings.Contains(-1));
+
+    postings.Compact();
+    ASSERT_EQUAL(CollectDocumentIds(postings), std::vector<int>(expected.begin(), expected.end()));
+    for (PostingList::Cursor cursor(postings); !cursor.IsEnd(); cursor.Next()) {
+        ASSERT_EQUAL(cursor.GetTermCount(), static_cast<uint32_t>(cursor.GetDocumentId() % 7 + 1));
+    }
+}
+
+// Границы блоков - оценки сверху для частот и ID документов блока
+void TestPostingListBlockBounds() {
+    std::mt19937 generator(5);
+    std::vector<double> inverse_word_counts(2000);
+    for (auto &inverse_word_count : inverse_word_counts) {
+        inverse_word_count = 1.0 / std::uniform_int_distribution(1, 30)(generator);
+    }
+    PostingList postings;
+    for (int document_id = 0; document_id < 2000; document_id += 3) {
+        const auto term_count = std::uniform_int_distribution<uint32_t>(1, 4)(generator);
+        postings.Add(document_id, term_count, term_count * inverse_word_counts[document_id]);
+    }
+
+    size_t checked = 0;
+    for (PostingList::Cursor cursor(postings, inverse_word_counts.data()); !cursor.IsEnd(); cursor.Next()) {
+        ASSERT(cursor.NextBlockGeq(cursor.GetDocumentId()));
+        ASSERT(cursor.GetDocumentId() <= cursor.GetBlockLastDocumentId());
+        ASSERT(cursor.GetTermFreq() <= cursor.GetBlockMaxTermFreq());
+        ASSERT(cursor.GetTermFreq() <= postings.GetMaxTermFreq());
+        ++checked;
+    }
+    ASSERT_EQUAL(checked, postings.size());
+}
+
+// Переход к блоку не сдвигает курсор, а переход к документу пропускает целые блоки
+void TestPostingListSkipsBlocks() {
+    PostingList postings;
+    for (int document_id = 0; document_id < 1000; ++document_id) {
+        postings.Add(document_id * 2, 1, 0.5);
+    }
+    PostingList::Cursor cursor(postings);
+    ASSERT(cursor.NextBlockGeq(1500));
+    ASSERT_EQUAL(cursor.GetDocumentId(), 0);
+    ASSERT(cursor.GetBlockLastDocumentId() >= 1500);
+    ASSERT(cursor.GetBlockLastDocumentId() < 1500 + 2 * static_cast<int>(PostingList::BLOCK_SIZE));
+    cursor.NextGeq(1501);
+    ASSERT_EQUAL(cursor.GetDocumentId(), 1502);
+    cursor.NextGeq(1998);
+    ASSERT_EQUAL(cursor.GetDocumentId(), 1998);
+    ASSERT(!cursor.NextBlockGeq(5000));
+    cursor.NextGeq(5000);
+    ASSERT(cursor.IsEnd());
+}
+
+// Сжатые блоки и хвост на границах блока хранят ID с большими разрывами и большие частоты
+void TestPostingListBlockEdges() {
+    const auto get_term_count = [](size_t i) {
+        return static_cast<uint32_t>(i % 2 == 0 ? i + 1 : (1u << 20) + i);
+    };
+    for (const size_t size : {PostingList::BLOCK_SIZE - 1, PostingList::BLOCK_SIZE, PostingList::BLOCK_SIZE + 1,
+                              2 * PostingList::BLOCK_SIZE, 2 * PostingList::BLOCK_SIZE + 1}) {
+        PostingList postings;
+        std::vector<int> expected;
+        for (size_t i = 0; i < size; ++i) {
+            const int document_id = static_cast<int>(i * i * 1000 + i % 3);
+            postings.Add(document_id, get_term_count(i), 0.5);
+            expected.push_back(document_id);
+        }
+        ASSERT_EQUAL(CollectDocumentIds(postings), expected);
+        size_t i = 0;
+        for (PostingList::Cursor cursor(postings); !cursor.IsEnd(); cursor.Next(), ++i) {
+            ASSERT_EQUAL(cursor.GetTermCount(), get_term_count(i));
+        }
+        PostingList::Cursor cursor(postings);
+        cursor.NextGeq(expected.back());
+        ASSERT_EQUAL(cursor.GetDocumentId(), expected.back());
+    }
+}
+
+} // namespace
+
+void RunPostingListTests(TestRunner &tr) {
+    RUN_TEST(tr, TestPostingListCursor);
+    RUN_TEST(tr, TestPostingListTermFreqs);
+    RUN_TEST(tr, TestPostingListMatchesSet);
+    RUN_TEST(tr, TestPostingListBlockBounds);
+    RUN_TEST(tr, TestPostingListSkipsBlocks);
+    RUN_TEST(tr, TestPostingListBlockEdges);
+}
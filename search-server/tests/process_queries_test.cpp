@@ -0,0 +1,100 @@
+#include "tests.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../process_queries.h"
+#include "../search_server.h"
+#include "reference_search.h"
+
+namespace {
+
+struct QueriesFixture {
+    SearchServer server{std::string("w0")};
+    std::vector<std::string> queries;
+    std::vector<std::vector<Document>> expected;
+
+    QueriesFixture() {
+        constexpr int vocabulary_size = 150;
+        std::mt19937 generator(21);
+        for (int id = 0; id < 2000; ++id) {
+            server.AddDocument(id, GenerateText(generator, vocabulary_size, 1, 10), DocumentStatus::ACTUAL, {id});
+        }
+        for (int i = 0; i < 200; ++i) {
+            queries.push_back(GenerateReferenceQuery(generator, vocabulary_size, 0.2));
+            expected.push_back(server.FindTopDocuments(queries.back()));
+        }
+        queries.push_back("unknown");
+        expected.emplace_back();
+    }
+};
+
+// Результаты запросов лежат в одном буфере подряд в порядке запросов
+void TestProcessQueriesJoined() {
+    const QueriesFixture fixture;
+    const JoinedDocuments joined = ProcessQueriesJoined(fixture.server, fixture.queries);
+    ASSERT_EQUAL(joined.GetQueryCount(), fixture.queries.size());
+
+    std::vector<Document> concatenated;
+    for (size_t query = 0; query < fixture.queries.size(); ++query) {
+        const auto range = joined.GetQueryDocuments(query);
+        AssertSameDocuments(std::vector<Document>(range.begin(), range.end()), fixture.expected[query],
+                            fixture.queries[query]);
+        concatenated.insert(concatenated.end(), fixture.expected[query].begin(), fixture.expected[query].end());
+    }
+    AssertSameDocuments(std::vector<Document>(joined.begin(), joined.end()), concatenated, "joined");
+    ASSERT_EQUAL(joined.size(), concatenated.size());
+    ASSERT_EQUAL(joined[0].id, concatenated[0].id);
+
+    const JoinedDocuments empty = ProcessQueriesJoined(fixture.server, {});
+    ASSERT(empty.empty());
+    ASSERT_EQUAL(empty.GetQueryCount(), 0u);
+}
+
+// Каждый запрос передаётся ровно один раз, и вызовы consumer не пересекаются
+void TestProcessQueriesStreamed() {
+    const QueriesFixture fixture;
+    std::vector<int> delivered(fixture.queries.size());
+    std::vector<std::vector<Document>> results(fixture.queries.size());
+    std::atomic<bool> in_consumer{false};
+    bool overlapped = false;
+    ProcessQueriesStreamed(fixture.server, fixture.queries,
+                           [&](size_t query, std::vector<Document> &&documents) {
+                               overlapped |= in_consumer.exchange(true);
+                               ++delivered[query];
+                               results[query] = std::move(documents);
+                               in_consumer.store(false);
+                           });
+    ASSERT(!overlapped);
+    for (size_t query = 0; query < fixture.queries.size(); ++query) {
+        ASSERT_EQUAL(delivered[query], 1);
+        AssertSameDocuments(results[query], fixture.expected[query], fixture.queries[query]);
+    }
+
+    // Выходной итератор получает те же документы, в порядке готовности запросов
+    std::vector<Document> streamed;
+    ProcessQueriesJoined(fixture.server, fixture.queries, std::back_inserter(streamed));
+    std::vector<int> streamed_ids, expected_ids;
+    for (const auto &document : streamed) {
+        streamed_ids.push_back(document.id);
+    }
+    for (const auto &documents : fixture.expected) {
+        for (const auto &document : documents) {
+            expected_ids.push_back(document.id);
+        }
+    }
+    std::sort(streamed_ids.begin(), streamed_ids.end());
+    std::sort(expected_ids.begin(), expected_ids.end());
+    ASSERT_EQUAL(streamed_ids, expected_ids);
+}
+
+} // namespace
+
+void RunProcessQueriesTests(TestRunner &tr) {
+    RUN_TEST(tr, TestProcessQueriesJoined);
+    RUN_TEST(tr, TestProcessQueriesStreamed);
+}
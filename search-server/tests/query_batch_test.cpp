@@ -0,0 +1,87 @@
+#include "tests.h"
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../search_server.h"
+#include "reference_search.h"
+
+namespace {
+
+// Запросы пакета находят то же, что и FindTopDocuments по одному, при любом статусе и числе документов
+void TestQueryBatchMatchesFindTopDocuments() {
+    constexpr int vocabulary_size = 150;
+    std::mt19937 generator(20);
+    SearchServer server(std::string("w0"));
+    server.SetMergePolicy({64, 3, 0.25});
+    const DocumentStatus statuses[] = {DocumentStatus::ACTUAL, DocumentStatus::IRRELEVANT, DocumentStatus::BANNED};
+    for (int id = 0; id < 2000; ++id) {
+        server.AddDocument(id, GenerateText(generator, vocabulary_size, 1, 10), statuses[id % 3], {id});
+        if (id % 7 == 6) {
+            server.RemoveDocument(id - 4);
+        }
+    }
+    std::vector<std::string> queries;
+    for (int i = 0; i < 100; ++i) {
+        queries.push_back(GenerateReferenceQuery(generator, vocabulary_size, 0.2));
+    }
+    // Повторы, стоп-слова и неизвестные слова
+    queries.push_back("w1 w1 w0 unknown -w2 -w2");
+    queries.push_back("w0");
+
+    for (const auto status : statuses) {
+        for (const size_t top_count : {size_t{1}, static_cast<size_t>(MAX_RESULT_DOCUMENT_COUNT), size_t{50}}) {
+            const SearchServer::QueryBatch batch(server, queries, status, top_count);
+            ASSERT_EQUAL(batch.size(), queries.size());
+            std::vector<Document> buffer(top_count);
+            for (size_t i = 0; i < queries.size(); ++i) {
+                const auto expected = server.FindTopDocuments(queries[i], status, top_count);
+                AssertSameDocuments(batch.FindTopDocuments(i), expected, queries[i]);
+                // Запись в буфер вызывающего даёт те же документы в том же порядке
+                const size_t count = batch.FindTopDocuments(i, buffer.data());
+                AssertSameDocuments(std::vector<Document>(buffer.begin(), buffer.begin() + count), expected,
+                                    queries[i]);
+            }
+        }
+    }
+}
+
+// Оценка трудоёмкости - число вхождений слов запроса плюс один
+void TestQueryBatchCosts() {
+    SearchServer server(std::string("and"));
+    server.AddDocument(1, "cat and dog", DocumentStatus::ACTUAL, {1});
+    server.AddDocument(2, "cat", DocumentStatus::ACTUAL, {2});
+    server.AddDocument(3, "bird", DocumentStatus::ACTUAL, {3});
+    const SearchServer::QueryBatch batch(server, {"cat", "cat -dog", "and fish", "cat bird dog"});
+    ASSERT_EQUAL(batch.GetQueryCost(0), 3u);
+    ASSERT_EQUAL(batch.GetQueryCost(1), 4u);
+    ASSERT_EQUAL(batch.GetQueryCost(2), 1u);
+    ASSERT_EQUAL(batch.GetQueryCost(3), 5u);
+}
+
+// Пакет читает версию индекса на момент создания, изменения после него не видит
+void TestQueryBatchKeepsVersion() {
+    SearchServer server(std::string("and"));
+    server.AddDocument(1, "cat and dog", DocumentStatus::ACTUAL, {1});
+    server.AddDocument(2, "cat", DocumentStatus::ACTUAL, {2});
+    const SearchServer::QueryBatch batch(server, {"cat", "parrot"});
+
+    server.RemoveDocument(1);
+    server.AddDocument(3, "cat parrot", DocumentStatus::ACTUAL, {3});
+    const auto cats = batch.FindTopDocuments(0);
+    ASSERT_EQUAL(cats.size(), 2u);
+    ASSERT(batch.FindTopDocuments(1).empty());
+    ASSERT_EQUAL(server.FindTopDocuments("parrot").size(), 1u);
+
+    ASSERT_THROWS(SearchServer::QueryBatch(server, {"cat", "-"}), std::invalid_argument);
+}
+
+} // namespace
+
+void RunQueryBatchTests(TestRunner &tr) {
+    RUN_TEST(tr, TestQueryBatchMatchesFindTopDocuments);
+    RUN_TEST(tr, TestQueryBatchCosts);
+    RUN_TEST(tr, TestQueryBatchKeepsVersion);
+}
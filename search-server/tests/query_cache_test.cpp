@@ -0,0 +1,118 @@
+#include "tests.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../query_cache.h"
+#include "../search_server.h"
+
+namespace {
+
+QueryCacheKey MakeKey(std::vector<TermId> plus_words, std::vector<TermId> minus_words = {}) {
+    return {std::move(plus_words), std::move(minus_words), DocumentStatus::ACTUAL, MAX_RESULT_DOCUMENT_COUNT};
+}
+
+std::vector<Document> MakeDocuments(int id) {
+    return {{id, 1.0, id}};
+}
+
+void TestQueryCacheKeys() {
+    const QueryCacheKeyHasher hasher;
+    ASSERT(MakeKey({1, 2}) == MakeKey({1, 2}));
+    ASSERT_EQUAL(hasher(MakeKey({1, 2})), hasher(MakeKey({1, 2})));
+    // Слово плюс или минус - разные запросы
+    ASSERT(!(MakeKey({1, 2}) == MakeKey({1}, {2})));
+    ASSERT(hasher(MakeKey({1, 2})) != hasher(MakeKey({1}, {2})));
+    auto banned = MakeKey({1});
+    banned.status = DocumentStatus::BANNED;
+    ASSERT(!(banned == MakeKey({1})));
+}
+
+// Результат находится только для поколения, по которому он найден, старый результат не затирает новый
+void TestQueryCacheGenerations() {
+    QueryCache cache({10, 2});
+    ASSERT(!cache.Find(MakeKey({1}), 0));
+    cache.Insert(MakeKey({1}), 0, MakeDocuments(5));
+    const auto found = cache.Find(MakeKey({1}), 0);
+    ASSERT(found && found->size() == 1 && found->front().id == 5);
+    ASSERT(!cache.Find(MakeKey({1}), 1));
+
+    cache.Insert(MakeKey({1}), 2, MakeDocuments(6));
+    cache.Insert(MakeKey({1}), 1, MakeDocuments(7));
+    ASSERT(cache.Find(MakeKey({1}), 2)->front().id == 6);
+
+    const auto statistics = cache.GetStatistics();
+    ASSERT_EQUAL(statistics.hits, 2u);
+    ASSERT_EQUAL(statistics.misses, 2u);
+    ASSERT_EQUAL(statistics.size, 1u);
+    ASSERT_EQUAL(statistics.GetHitRate(), 0.5);
+}
+
+// Вытесняется давно не использованный результат
+void TestQueryCacheEvictsLeastRecentlyUsed() {
+    QueryCache cache({2, 1});
+    cache.Insert(MakeKey({1}), 0, MakeDocuments(1));
+    cache.Insert(MakeKey({2}), 0, MakeDocuments(2));
+    ASSERT(cache.Find(MakeKey({1}), 0));
+    cache.Insert(MakeKey({3}), 0, MakeDocuments(3));
+    ASSERT(cache.Find(MakeKey({1}), 0));
+    ASSERT(!cache.Find(MakeKey({2}), 0));
+    ASSERT(cache.Find(MakeKey({3}), 0));
+    ASSERT_EQUAL(cache.GetStatistics().evictions, 1u);
+}
+
+// Части кеша вместе вмещают ровно capacity результатов, в том числе когда частей больше ёмкости
+void TestQueryCacheCapacityIsExact() {
+    for (const auto &options : {QueryCacheOptions{10, 4}, QueryCacheOptions{3, 16}, QueryCacheOptions{17, 16}}) {
+        QueryCache cache(options);
+        for (TermId term_id = 0; term_id < 1000; ++term_id) {
+            cache.Insert(MakeKey({term_id}), 0, MakeDocuments(static_cast<int>(term_id)));
+        }
+        ASSERT_EQUAL(cache.GetStatistics().size, options.capacity);
+    }
+    ASSERT_THROWS(QueryCache({0, 4}), std::invalid_argument);
+    ASSERT_THROWS(QueryCache({10, 0}), std::invalid_argument);
+}
+
+// Повтор запроса берётся из кеша, изменение индекса делает сохранённые результаты устаревшими
+void TestSearchServerQueryCache() {
+    SearchServer server(std::string("and"));
+    server.AddDocument(1, "white cat and collar", DocumentStatus::ACTUAL, {1});
+    server.AddDocument(2, "fluffy cat", DocumentStatus::ACTUAL, {2});
+    server.SetQueryCacheOptions({100, 4});
+
+    ASSERT_EQUAL(server.FindTopDocuments("cat").size(), 2u);
+    // Порядок и повторы слов не меняют ключ
+    ASSERT_EQUAL(server.FindTopDocuments("cat cat").size(), 2u);
+    ASSERT_EQUAL(server.GetQueryCacheStatistics().hits, 1u);
+
+    server.AddDocument(3, "cat", DocumentStatus::ACTUAL, {3});
+    ASSERT_EQUAL(server.FindTopDocuments("cat").size(), 3u);
+    server.RemoveDocument(1);
+    ASSERT_EQUAL(server.FindTopDocuments("cat").size(), 2u);
+    // Поиск с предикатом кеш не использует
+    server.FindTopDocuments("cat", [](int, DocumentStatus, int) {
+        return true;
+    });
+    auto statistics = server.GetQueryCacheStatistics();
+    ASSERT_EQUAL(statistics.hits, 1u);
+    ASSERT_EQUAL(statistics.misses, 3u);
+
+    server.SetQueryCacheOptions({0, 4});
+    server.FindTopDocuments("cat");
+    statistics = server.GetQueryCacheStatistics();
+    ASSERT_EQUAL(statistics.hits + statistics.misses, 0u);
+    ASSERT_THROWS(server.SetQueryCacheOptions({10, 0}), std::invalid_argument);
+}
+
+} // namespace
+
+void RunQueryCacheTests(TestRunner &tr) {
+    RUN_TEST(tr, TestQueryCacheKeys);
+    RUN_TEST(tr, TestQueryCacheGenerations);
+    RUN_TEST(tr, TestQueryCacheEvictsLeastRecentlyUsed);
+    RUN_TEST(tr, TestQueryCacheCapacityIsExact);
+    RUN_TEST(tr, TestSearchServerQueryCache);
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../document.h"
+#include "../string_processing.h"
+#include "../test_framework.h"
+
+// Эталонный поиск полным перебором по текстам документов: TF-IDF без индексов и отсечений.
+// Тесты сверяют с ним выдачу сервера
+class ReferenceSearch {
+public:
+    explicit ReferenceSearch(const std::string &stop_words) {
+        for (const auto word : SplitIntoWords(stop_words)) {
+            stop_words_.emplace(word);
+        }
+    }
+
+    void AddDocument(int id, const std::string &text, DocumentStatus status, int rating) {
+        RemoveDocument(id);
+        auto &document = documents_[id];
+        document.status = status;
+        document.rating = rating;
+        size_t word_count = 0;
+        for (const auto word : SplitIntoWords(text)) {
+            if (stop_words_.count(std::string(word)) == 0) {
+                ++document.word_counts[std::string(word)];
+                ++word_count;
+            }
+        }
+        document.word_count = word_count;
+        for (const auto &[word, count] : document.word_counts) {
+            ++document_freqs_[word];
+        }
+    }
+
+    void RemoveDocument(int id) {
+        const auto it = documents_.find(id);
+        if (it == documents_.end()) {
+            return;
+        }
+        for (const auto &[word, count] : it->second.word_counts) {
+            --document_freqs_[word];
+        }
+        documents_.erase(it);
+    }
+
+    std::vector<Document> FindTopDocuments(const std::string &query, DocumentStatus status, size_t top_count) const {
+        std::set<std::string> plus_words;
+        std::set<std::string> minus_words;
+        for (const auto word : SplitIntoWords(query)) {
+            if (!word.empty() && word[0] == '-') {
+                minus_words.emplace(word.substr(1));
+            } else {
+                plus_words.emplace(word);
+            }
+        }
+
+        std::vector<Document> result;
+        for (const auto &[id, document] : documents_) {
+            if (document.status != status) {
+                continue;
+            }
+            const bool has_minus_word = std::any_of(minus_words.begin(), minus_words.end(), [&](const auto &word) {
+                return document.word_counts.count(word) != 0;
+            });
+            if (has_minus_word) {
+                continue;
+            }
+            double relevance = 0.0;
+            bool is_found = false;
+            for (const auto &word : plus_words) {
+                const auto it = document.word_counts.find(word);
+                if (it == document.word_counts.end() || stop_words_.count(word) != 0) {
+                    continue;
+                }
+                is_found = true;
+                const double inverse_document_freq = std::log(static_cast<double>(documents_.size())
+                                                              / document_freqs_.at(word));
+                relevance += inverse_document_freq * it->second / static_cast<double>(document.word_count);
+            }
+            if (is_found) {
+                result.emplace_back(id, relevance, document.rating);
+            }
+        }
+        std::sort(result.begin(), result.end(), IsMoreRelevant);
+        result.resize(std::min(result.size(), top_count));
+        return result;
+    }
+
+private:
+    struct DocumentData {
+        DocumentStatus status;
+        int rating;
+        size_t word_count = 0;
+        std::map<std::string, int> word_counts;
+    };
+
+    std::set<std::string> stop_words_;
+    std::map<int, DocumentData> documents_;
+    std::map<std::string, int> document_freqs_;
+};
+
+// Случайный текст из слов "w0".."w<vocabulary_size - 1>". Частые слова - с малыми номерами,
+// поэтому их списки вхождений занимают много блоков
+inline std::string GenerateText(std::mt19937 &generator, int vocabulary_size, int min_words, int max_words) {
+    const int word_count = std::uniform_int_distribution(min_words, max_words)(generator);
+    std::string text;
+    for (int i = 0; i < word_count; ++i) {
+        const double x = std::uniform_real_distribution(0.0, 1.0)(generator);
+        const int word = static_cast<int>(vocabulary_size * x * x * x);
+        if (!text.empty()) {
+            text.push_back(' ');
+        }
+        text += "w" + std::to_string(word);
+    }
+    return text;
+}
+
+// Запрос из плюс-слов и, с вероятностью minus_probability для каждого слова, минус-слов
+inline std::string GenerateReferenceQuery(std::mt19937 &generator, int vocabulary_size, double minus_probability) {
+    const int word_count = std::uniform_int_distribution(1, 4)(generator);
+    std::string query;
+    for (int i = 0; i < word_count; ++i) {
+        if (!query.empty()) {
+            query.push_back(' ');
+        }
+        if (std::uniform_real_distribution(0.0, 1.0)(generator) < minus_probability) {
+            query.push_back('-');
+        }
+        query += "w" + std::to_string(std::uniform_int_distribution(0, vocabulary_size - 1)(generator));
+    }
+    return query;
+}
+
+// Выдачи совпадают по ID и релевантности. Документы с релевантностями в пределах EPSILON
+// упорядочены по рейтингу, поэтому сравнение по позициям однозначно при различных рейтингах
+inline void AssertSameDocuments(const std::vector<Document> &actual, const std::vector<Document> &expected,
+                                const std::string &hint) {
+    AssertEqual(actual.size(), expected.size(), hint + ": result size");
+    for (size_t i = 0; i < actual.size(); ++i) {
+        std::ostringstream position;
+        position << hint << ": position " << i;
+        AssertEqual(actual[i].id, expected[i].id, position.str());
+        Assert(std::abs(actual[i].relevance - expected[i].relevance) < EPSILON, position.str() + " relevance");
+    }
+}
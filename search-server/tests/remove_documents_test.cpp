@@ -0,0 +1,155 @@
+#include "tests.h"
+
+#include <execution>
+#include <filesystem>
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../search_server.h"
+#include "../string_processing.h"
+#include "reference_search.h"
+
+namespace {
+
+std::vector<int> GetIds(const std::vector<Document> &documents) {
+    std::vector<int> ids;
+    for (const auto &document : documents) {
+        ids.push_back(document.id);
+    }
+    return ids;
+}
+
+// Удалённый документ сразу перестаёт находиться и учитываться, повторное удаление ничего не делает
+void TestRemovedDocumentIsNotFound() {
+    SearchServer server(std::string("and"));
+    server.AddDocument(1, "cat and dog", DocumentStatus::ACTUAL, {1});
+    server.AddDocument(2, "cat", DocumentStatus::ACTUAL, {2});
+    server.AddDocument(3, "bird", DocumentStatus::ACTUAL, {3});
+
+    server.RemoveDocument(1);
+    ASSERT_EQUAL(server.GetDocumentCount(), 2);
+    ASSERT_EQUAL(GetIds(server.FindTopDocuments("cat")), std::vector<int>({2}));
+    ASSERT(server.FindTopDocuments("dog").empty());
+    ASSERT_THROWS(server.MatchDocument("cat", 1), std::out_of_range);
+    server.RemoveDocument(1);
+    ASSERT_EQUAL(server.GetDocumentCount(), 2);
+
+    server.RemoveDocument(std::execution::par, 3);
+    server.RemoveDocuments({2, 3, 100});
+    ASSERT_EQUAL(server.GetDocumentCount(), 0);
+    ASSERT(server.FindTopDocuments("cat bird").empty());
+}
+
+// Документы добавляются и удаляются скользящим окном: слияния отбрасывают удалённые документы
+// и перенумеровывают оставшиеся, а выдача и совпадения слов остаются верными
+void TestChurnMatchesReference() {
+    constexpr int vocabulary_size = 150;
+    constexpr int window = 300;
+    std::mt19937 generator(14);
+    SearchServer server(std::string("w0"));
+    server.SetMergePolicy({32, 3, 0.25});
+    ReferenceSearch reference("w0");
+    std::map<int, std::string> texts;
+    std::vector<int> removed_batch;
+
+    const auto check = [&] {
+        for (int i = 0; i < 20; ++i) {
+            const std::string query = GenerateReferenceQuery(generator, vocabulary_size, 0.2);
+            AssertSameDocuments(server.FindTopDocuments(query),
+                                reference.FindTopDocuments(query, DocumentStatus::ACTUAL, MAX_RESULT_DOCUMENT_COUNT),
+                                query);
+        }
+        // Запрос из всех слов документа совпадает со всеми его словами, кроме стоп-слова
+        int index = 0;
+        for (const auto &[id, text] : texts) {
+            if (index++ % 37 != 0) {
+                continue;
+            }
+            std::set<std::string> expected_words;
+            for (const auto word : SplitIntoWords(text)) {
+                if (word != "w0") {
+                    expected_words.emplace(word);
+                }
+            }
+            const auto [words, status] = server.MatchDocument(text, id);
+            ASSERT_EQUAL(std::set<std::string>(words.begin(), words.end()), expected_words);
+        }
+    };
+
+    for (int id = 0; id < 6000; ++id) {
+        const std::string text = GenerateText(generator, vocabulary_size, 1, 10);
+        server.AddDocument(id, text, DocumentStatus::ACTUAL, {id});
+        reference.AddDocument(id, text, DocumentStatus::ACTUAL, id);
+        texts.emplace(id, text);
+        if (id >= window) {
+            const int removed_id = id - window;
+            // Половина удалений идёт пакетами
+            if (removed_id % 100 < 50) {
+                server.RemoveDocument(removed_id);
+            } else {
+                removed_batch.push_back(removed_id);
+                if (removed_batch.size() == 10) {
+                    server.RemoveDocuments(removed_batch);
+                    removed_batch.clear();
+                }
+            }
+            reference.RemoveDocument(removed_id);
+            texts.erase(removed_id);
+        }
+        if (removed_batch.empty() && id % 1000 == 999) {
+            check();
+        }
+    }
+    server.RemoveDocuments(removed_batch);
+    server.WaitForMerges();
+    ASSERT_EQUAL(server.GetDocumentCount(), window);
+    check();
+}
+
+// Номера и данные отброшенных слиянием документов освобождаются: снимок сервера после
+// долгой смены документов не больше, чем в разы, снимка сервера только с живыми документами
+void TestRemovedSlotsAreReclaimed() {
+    constexpr int vocabulary_size = 100;
+    constexpr int window = 200;
+    std::mt19937 generator(15);
+    SearchServer churned(std::string("w0"));
+    churned.SetMergePolicy({32, 3, 0.25});
+    std::map<int, std::string> texts;
+    for (int id = 0; id < 20000; ++id) {
+        texts.emplace(id, GenerateText(generator, vocabulary_size, 1, 10));
+        churned.AddDocument(id, texts.at(id), DocumentStatus::ACTUAL, {1});
+        if (id >= window) {
+            churned.RemoveDocument(id - window);
+            texts.erase(id - window);
+        }
+    }
+    churned.WaitForMerges();
+
+    SearchServer fresh(std::string("w0"));
+    for (const auto &[id, text] : texts) {
+        fresh.AddDocument(id, text, DocumentStatus::ACTUAL, {1});
+    }
+
+    const auto directory = std::filesystem::temp_directory_path();
+    const std::string churned_path = (directory / "remove_documents_test_churned.idx").string();
+    const std::string fresh_path = (directory / "remove_documents_test_fresh.idx").string();
+    churned.Save(churned_path, false);
+    fresh.Save(fresh_path, false);
+    const auto churned_size = std::filesystem::file_size(churned_path);
+    const auto fresh_size = std::filesystem::file_size(fresh_path);
+    std::filesystem::remove(churned_path);
+    std::filesystem::remove(fresh_path);
+    ASSERT(churned_size < 3 * fresh_size);
+}
+
+} // namespace
+
+void RunRemoveDocumentsTests(TestRunner &tr) {
+    RUN_TEST(tr, TestRemovedDocumentIsNotFound);
+    RUN_TEST(tr, TestChurnMatchesReference);
+    RUN_TEST(tr, TestRemovedSlotsAreReclaimed);
+}
@@ -0,0 +1,233 @@
+#include "tests.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../duplicate_index.h"
+#include "../remove_duplicates.h"
+#include "../search_server.h"
+#include "../string_processing.h"
+#include "reference_search.h"
+
+namespace {
+
+// Перенаправит std::cout в строку на время жизни объекта
+class CoutCapture {
+public:
+    CoutCapture()
+            : old_buffer_(std::cout.rdbuf(output_.rdbuf())) {
+    }
+
+    ~CoutCapture() {
+        std::cout.rdbuf(old_buffer_);
+    }
+
+    std::string GetOutput() const {
+        return output_.str();
+    }
+
+private:
+    std::ostringstream output_;
+    std::streambuf *old_buffer_;
+};
+
+std::vector<int> GetIds(const SearchServer &server) {
+    return {server.begin(), server.end()};
+}
+
+// Отпечаток не зависит от порядка слов и различает разные наборы
+void TestTermSetFingerprint() {
+    ASSERT(ComputeTermSetFingerprint(std::vector<TermId>{1, 2, 3})
+           == ComputeTermSetFingerprint(std::vector<TermId>{3, 1, 2}));
+    ASSERT(!(ComputeTermSetFingerprint(std::vector<TermId>{1, 2, 3})
+             == ComputeTermSetFingerprint(std::vector<TermId>{1, 2, 4})));
+    ASSERT(!(ComputeTermSetFingerprint(std::vector<TermId>{1, 2})
+             == ComputeTermSetFingerprint(std::vector<TermId>{1, 2, 3})));
+    ASSERT(ComputeTermSetFingerprint(std::vector<TermId>{}) == TermSetFingerprint{});
+}
+
+// Удаляются документы с тем же набором слов, что у документа с меньшим ID,
+// независимо от порядка и числа повторов слов
+void TestRemoveDuplicates() {
+    SearchServer server(std::string("and with"));
+    server.AddDocument(1, "funny pet and nasty rat", DocumentStatus::ACTUAL, {7, 2, 7});
+    server.AddDocument(2, "funny pet with curly hair", DocumentStatus::ACTUAL, {1, 2});
+    server.AddDocument(3, "funny pet with curly hair", DocumentStatus::ACTUAL, {1, 2});
+    server.AddDocument(4, "funny pet and curly hair", DocumentStatus::ACTUAL, {1, 2});
+    server.AddDocument(5, "funny funny pet and nasty nasty rat", DocumentStatus::ACTUAL, {1, 2});
+    server.AddDocument(6, "funny pet and not very nasty rat", DocumentStatus::ACTUAL, {1, 2});
+    server.AddDocument(7, "very nasty rat and not very funny pet", DocumentStatus::ACTUAL, {1, 2});
+    server.AddDocument(8, "pet with rat and rat and rat", DocumentStatus::ACTUAL, {1, 2});
+    server.AddDocument(9, "nasty rat with curly hair", DocumentStatus::ACTUAL, {1, 2});
+
+    CoutCapture capture;
+    RemoveDuplicates(server);
+    ASSERT_EQUAL(GetIds(server), std::vector<int>({1, 2, 6, 8, 9}));
+    ASSERT_EQUAL(capture.GetOutput(), "Found duplicate document id 3\nFound duplicate document id 4\n"
+                                      "Found duplicate document id 5\nFound duplicate document id 7\n");
+    ASSERT(server.FindTopDocuments("curly").size() == 2);
+
+    // Повторный вызов ничего не удаляет
+    RemoveDuplicates(server);
+    ASSERT_EQUAL(GetIds(server), std::vector<int>({1, 2, 6, 8, 9}));
+}
+
+// Результат совпадает с прямым сравнением наборов слов, в том числе после удалений из сервера
+void TestRemoveDuplicatesMatchesSets() {
+    std::mt19937 generator(22);
+    SearchServer server(std::string("w0"));
+    std::vector<std::string> texts;
+    for (int id = 0; id < 3000; ++id) {
+        // Часть документов - перестановки слов более ранних документов
+        std::string text;
+        if (id > 0 && id % 4 == 0) {
+            auto words = SplitIntoWords(texts[std::uniform_int_distribution(0, id - 1)(generator)]);
+            std::shuffle(words.begin(), words.end(), generator);
+            for (const auto word : words) {
+                text += (text.empty() ? "" : " ") + std::string(word);
+            }
+        } else {
+            text = GenerateText(generator, 40, 1, 4);
+        }
+        texts.push_back(text);
+        server.AddDocument(id, text, DocumentStatus::ACTUAL, {id});
+        if (id % 10 == 9) {
+            server.RemoveDocument(id - 5);
+        }
+    }
+
+    std::vector<int> expected;
+    std::set<std::set<std::string>> seen;
+    for (const int id : server) {
+        std::set<std::string> words;
+        for (const auto word : SplitIntoWords(texts[id])) {
+            if (word != "w0") {
+                words.emplace(word);
+            }
+        }
+        if (seen.insert(words).second) {
+            expected.push_back(id);
+        }
+    }
+    CoutCapture capture;
+    RemoveDuplicates(server);
+    ASSERT_EQUAL(GetIds(server), expected);
+}
+
+std::string JoinWords(const std::vector<std::string> &words) {
+    std::string text;
+    for (const auto &word : words) {
+        text += (text.empty() ? "" : " ") + word;
+    }
+    return text;
+}
+
+void TestCheckNearDuplicateOptions() {
+    CheckNearDuplicateOptions({});
+    ASSERT_THROWS(CheckNearDuplicateOptions({0.0, 128, 32}), std::invalid_argument);
+    ASSERT_THROWS(CheckNearDuplicateOptions({1.5, 128, 32}), std::invalid_argument);
+    ASSERT_THROWS(CheckNearDuplicateOptions({0.8, 128, 0}), std::invalid_argument);
+    ASSERT_THROWS(CheckNearDuplicateOptions({0.8, 100, 32}), std::invalid_argument);
+}
+
+// Почти копии находятся вместе с оставляемым документом и точным сходством,
+// непохожие документы копиями не считаются
+void TestFindNearDuplicates() {
+    std::vector<std::string> words;
+    for (int i = 0; i < 20; ++i) {
+        words.push_back("word" + std::to_string(i));
+    }
+    SearchServer server(std::string("and"));
+    server.AddDocument(1, JoinWords(words), DocumentStatus::ACTUAL, {1});
+    server.AddDocument(2, "completely different text", DocumentStatus::ACTUAL, {1});
+    auto changed = words;
+    changed[5] = "other";
+    server.AddDocument(3, JoinWords(changed), DocumentStatus::ACTUAL, {1});
+    server.AddDocument(4, "different text and completely", DocumentStatus::ACTUAL, {1});
+    auto half = std::vector<std::string>(words.begin(), words.begin() + 10);
+    server.AddDocument(5, JoinWords(half), DocumentStatus::ACTUAL, {1});
+
+    const auto duplicates = FindNearDuplicates(server);
+    ASSERT_EQUAL(duplicates.size(), 2u);
+    ASSERT_EQUAL(duplicates[0].document_id, 3);
+    ASSERT_EQUAL(duplicates[0].original_id, 1);
+    ASSERT(std::abs(duplicates[0].similarity - 19.0 / 21.0) < 1e-9);
+    ASSERT_EQUAL(duplicates[1].document_id, 4);
+    ASSERT_EQUAL(duplicates[1].original_id, 2);
+    ASSERT_EQUAL(duplicates[1].similarity, 1.0);
+    // Половина слов - сходство 0.5, копией не считается, пока порог выше
+    ASSERT_EQUAL(FindNearDuplicates(server, {0.4, 128, 32}).size(), 3u);
+
+    CoutCapture capture;
+    RemoveNearDuplicates(server);
+    ASSERT_EQUAL(GetIds(server), std::vector<int>({1, 2, 5}));
+    ASSERT(FindNearDuplicates(server).empty());
+}
+
+// Найденные пары действительно похожи, а пары с высоким сходством не пропускаются
+void TestFindNearDuplicatesMatchesExactSimilarity() {
+    std::mt19937 generator(23);
+    SearchServer server(std::string("w0"));
+    std::vector<std::set<std::string>> word_sets;
+    for (int id = 0; id < 600; ++id) {
+        std::set<std::string> words;
+        if (id > 0 && id % 3 == 0) {
+            // Копия более раннего документа с заменой одного слова из многих
+            words = word_sets[std::uniform_int_distribution(0, id - 1)(generator)];
+            if (words.size() > 1) {
+                words.erase(words.begin());
+            }
+            words.insert("u" + std::to_string(id));
+        }
+        while (words.size() < 25) {
+            words.insert("w" + std::to_string(std::uniform_int_distribution(1, 2000)(generator)));
+        }
+        word_sets.push_back(words);
+        server.AddDocument(id, JoinWords({words.begin(), words.end()}), DocumentStatus::ACTUAL, {id});
+    }
+
+    const auto similarity = [&word_sets](int lhs, int rhs) {
+        std::vector<std::string> common;
+        std::set_intersection(word_sets[lhs].begin(), word_sets[lhs].end(), word_sets[rhs].begin(),
+                              word_sets[rhs].end(), std::back_inserter(common));
+        return static_cast<double>(common.size())
+               / static_cast<double>(word_sets[lhs].size() + word_sets[rhs].size() - common.size());
+    };
+    const NearDuplicateOptions options{0.8, 128, 32};
+    const auto duplicates = FindNearDuplicates(server, options);
+    std::set<int> found;
+    for (const auto &duplicate : duplicates) {
+        ASSERT(duplicate.original_id < duplicate.document_id);
+        ASSERT(std::abs(duplicate.similarity - similarity(duplicate.document_id, duplicate.original_id)) < 1e-9);
+        ASSERT(duplicate.similarity >= options.min_similarity);
+        found.insert(duplicate.document_id);
+    }
+    // Сходство 0.92 и выше: вероятность пропуска пары по 32 полосам ничтожна
+    for (int id = 0; id < 600; ++id) {
+        for (int original = 0; original < id; ++original) {
+            if (similarity(id, original) >= 0.92) {
+                ASSERT(found.count(id) == 1);
+            }
+        }
+    }
+    ASSERT(found.size() >= 150);
+}
+
+} // namespace
+
+void RunRemoveDuplicatesTests(TestRunner &tr) {
+    RUN_TEST(tr, TestTermSetFingerprint);
+    RUN_TEST(tr, TestRemoveDuplicates);
+    RUN_TEST(tr, TestRemoveDuplicatesMatchesSets);
+    RUN_TEST(tr, TestCheckNearDuplicateOptions);
+    RUN_TEST(tr, TestFindNearDuplicates);
+    RUN_TEST(tr, TestFindNearDuplicatesMatchesExactSimilarity);
+}
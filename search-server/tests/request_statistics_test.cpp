@@ -0,0 +1,119 @@
+#include "tests.h"
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "../request_statistics.h"
+
+namespace {
+
+using namespace std::chrono_literals;
+
+void AssertCounts(const RequestCounts &counts, uint64_t total, uint64_t no_result, uint64_t slow) {
+    ASSERT_EQUAL(counts.total, total);
+    ASSERT_EQUAL(counts.no_result, no_result);
+    ASSERT_EQUAL(counts.slow, slow);
+}
+
+void TestCheckRequestStatisticsOptions() {
+    CheckRequestStatisticsOptions({});
+    ASSERT_THROWS(CheckRequestStatisticsOptions({24h, 0, 100ms}), std::invalid_argument);
+    ASSERT_THROWS(CheckRequestStatisticsOptions({24h, size_t{1} << 22, 100ms}), std::invalid_argument);
+    ASSERT_THROWS(CheckRequestStatisticsOptions({10ns, 60, 100ms}), std::invalid_argument);
+    ASSERT_THROWS(CheckRequestStatisticsOptions({24h, 1440, -1ms}), std::invalid_argument);
+    ASSERT_THROWS(RequestStatistics({24h, 0, 100ms}), std::invalid_argument);
+}
+
+// Запросы выходят из окна целыми интервалами, медленные и безрезультатные считаются отдельно
+void TestRequestsExpire() {
+    RequestStatistics statistics({60s, 60, 100ms});
+    const auto start = RequestStatistics::Clock::now();
+    statistics.Record(true, 1ms, start);
+    statistics.Record(false, 1ms, start);
+    statistics.Record(true, 100ms, start + 500ms);
+    AssertCounts(statistics.GetCounts(start + 1s), 3, 1, 1);
+
+    statistics.Record(false, 200ms, start + 30s);
+    AssertCounts(statistics.GetCounts(start + 59s), 4, 2, 2);
+    AssertCounts(statistics.GetCounts(start + 61s), 1, 1, 1);
+    AssertCounts(statistics.GetCounts(start + 91s), 0, 0, 0);
+
+    statistics.Record(true, 1ms, start + 91s);
+    AssertCounts(statistics.GetCounts(start + 100s), 1, 0, 0);
+}
+
+// Одновременная запись из нескольких потоков, в том числе при сдвиге окна, не теряет запросов
+void TestConcurrentRecord() {
+    constexpr int thread_count = 4;
+    constexpr int request_count = 20000;
+    RequestStatistics statistics({1s, 100, 100ms});
+    const auto start = RequestStatistics::Clock::now();
+
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < thread_count; ++thread) {
+        threads.emplace_back([&statistics, start]() {
+            for (int i = 0; i < request_count; ++i) {
+                // Все запросы попадают в одно окно, но в разные его интервалы
+                const auto now = start + std::chrono::microseconds(i * 25);
+                statistics.Record(i % 2 == 0, i % 4 == 0 ? 100ms : 1ms, now);
+                if (i % 1000 == 0) {
+                    statistics.GetCounts(now);
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    const auto last = start + std::chrono::microseconds((request_count - 1) * 25);
+    AssertCounts(statistics.GetCounts(last), thread_count * request_count, thread_count * request_count / 2,
+                 thread_count * request_count / 4);
+    AssertCounts(statistics.GetCounts(last + 1s), 0, 0, 0);
+}
+
+// После простоя, кратного или почти кратного числу номеров интервалов в счётчике,
+// старые запросы не возвращаются в окно
+void TestLongIdleGap() {
+    // Интервал в 1 мкс: 2^24 интервала проходят за 17 секунд
+    constexpr size_t interval_count = 1000;
+    const RequestStatisticsOptions options{std::chrono::microseconds(interval_count), interval_count, 100ms};
+    const std::chrono::microseconds tag_period(1 << 24);
+    const std::chrono::microseconds window(interval_count);
+
+    const std::chrono::microseconds gaps[] = {
+            tag_period / 2 + window, tag_period - window, tag_period - window / 2,
+            tag_period, tag_period + window / 2, tag_period * 5, tag_period * 5 - 3us,
+    };
+    for (const auto gap : gaps) {
+        RequestStatistics statistics(options);
+        const auto start = RequestStatistics::Clock::now();
+        for (int i = 0; i < 100; ++i) {
+            statistics.Record(false, 100ms, start + std::chrono::microseconds(i * 7));
+        }
+        AssertCounts(statistics.GetCounts(start + 700us), 100, 100, 100);
+
+        // Первый запрос после простоя приходит раньше чтения сумм
+        statistics.Record(true, 1ms, start + gap);
+        AssertCounts(statistics.GetCounts(start + gap), 1, 0, 0);
+        statistics.Record(true, 1ms, start + gap + window / 2);
+        AssertCounts(statistics.GetCounts(start + gap + window / 2), 2, 0, 0);
+        AssertCounts(statistics.GetCounts(start + gap + window * 2), 0, 0, 0);
+
+        // Простой без запросов перед чтением сумм
+        statistics.Record(false, 1ms, start + gap * 2);
+        AssertCounts(statistics.GetCounts(start + gap * 3), 0, 0, 0);
+        statistics.Record(false, 1ms, start + gap * 3);
+        AssertCounts(statistics.GetCounts(start + gap * 3), 1, 1, 0);
+    }
+}
+
+} // namespace
+
+void RunRequestStatisticsTests(TestRunner &tr) {
+    RUN_TEST(tr, TestCheckRequestStatisticsOptions);
+    RUN_TEST(tr, TestRequestsExpire);
+    RUN_TEST(tr, TestConcurrentRecord);
+    RUN_TEST(tr, TestLongIdleGap);
+}
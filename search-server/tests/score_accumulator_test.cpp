@@ -0,0 +1,144 @@
+#include "tests.h"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../score_accumulator.h"
+#include "../search_server.h"
+#include "reference_search.h"
+
+namespace {
+
+void TestScoreAccumulatorStates() {
+    ScoreAccumulator accumulator;
+    accumulator.Reset(100, 10);
+    ASSERT(!accumulator.IsTouched(103));
+    accumulator.Accept(103);
+    accumulator.Add(103, 0.5);
+    accumulator.Add(103, 0.25);
+    accumulator.Reject(107);
+    accumulator.Accept(107);
+    accumulator.Reject(101);
+    ASSERT(accumulator.IsTouched(103));
+    ASSERT(!accumulator.IsRejected(103));
+    ASSERT(accumulator.IsRejected(101));
+    ASSERT(!accumulator.IsRejected(107));
+    ASSERT_EQUAL(accumulator.GetRelevance(103), 0.75);
+    ASSERT_EQUAL(accumulator.GetTouched(), std::vector<int>({103, 107, 101}));
+}
+
+// После Clear затронутые документы снова чисты, в том числе при другом диапазоне номеров
+void TestScoreAccumulatorClear() {
+    ScoreAccumulator accumulator;
+    accumulator.Reset(0, 8);
+    accumulator.Accept(2);
+    accumulator.Add(2, 1.0);
+    accumulator.Reject(5);
+    accumulator.Clear();
+    ASSERT(accumulator.GetTouched().empty());
+    for (int document = 0; document < 8; ++document) {
+        ASSERT(!accumulator.IsTouched(document));
+        ASSERT_EQUAL(accumulator.GetRelevance(document), 0.0);
+    }
+
+    accumulator.Reset(4, 16);
+    accumulator.Accept(19);
+    accumulator.Add(19, 2.0);
+    ASSERT_EQUAL(accumulator.GetRelevance(19), 2.0);
+    ASSERT(!accumulator.IsTouched(6));
+}
+
+// Reset без Clear сбрасывает документы прерванного запроса, даже если диапазон номеров сменился
+void TestScoreAccumulatorResetWithoutClear() {
+    ScoreAccumulator accumulator;
+    accumulator.Reset(100, 10);
+    accumulator.Accept(109);
+    accumulator.Add(109, 1.0);
+    accumulator.Reject(100);
+
+    accumulator.Reset(0, 4);
+    ASSERT(accumulator.GetTouched().empty());
+    accumulator.Reset(100, 10);
+    ASSERT(!accumulator.IsTouched(109));
+    ASSERT(!accumulator.IsTouched(100));
+    ASSERT_EQUAL(accumulator.GetRelevance(109), 0.0);
+}
+
+// Исключение из предиката не оставляет следов в следующих запросах того же потока
+void TestThrowingPredicate() {
+    constexpr int vocabulary_size = 30;
+    std::mt19937 generator(61);
+    SearchServer server(std::string("w0"));
+    server.SetMergePolicy({64, 3, 0.25});
+    ReferenceSearch reference("w0");
+    for (int id = 0; id < 600; ++id) {
+        const std::string text = GenerateText(generator, vocabulary_size, 1, 6);
+        server.AddDocument(id, text, DocumentStatus::ACTUAL, {id});
+        reference.AddDocument(id, text, DocumentStatus::ACTUAL, id);
+    }
+    ASSERT(server.GetSegmentCount() > 1);
+
+    for (int i = 0; i < 50; ++i) {
+        const std::string query = GenerateReferenceQuery(generator, vocabulary_size, 0.2);
+        const auto expected = reference.FindTopDocuments(query, DocumentStatus::ACTUAL, 1000);
+        // Предикат вызывается не реже раза на найденный документ
+        const int throw_after = i % static_cast<int>(std::clamp<size_t>(expected.size(), 1, 5));
+        int calls = 0;
+        const auto throwing_predicate = [&calls, throw_after](int, DocumentStatus, int) {
+            if (calls++ == throw_after) {
+                throw std::runtime_error("predicate");
+            }
+            return true;
+        };
+        if (!expected.empty()) {
+            ASSERT_THROWS(server.FindTopDocuments(query, throwing_predicate, 1000), std::runtime_error);
+        }
+        AssertSameDocuments(server.FindTopDocuments(query, DocumentStatus::ACTUAL, 1000), expected, query);
+    }
+}
+
+// Поиск с произвольным предикатом совпадает с полным перебором по всем статусам
+void TestFindTopDocumentsWithPredicate() {
+    constexpr int vocabulary_size = 100;
+    std::mt19937 generator(6);
+    SearchServer server(std::string("w0"));
+    ReferenceSearch reference("w0");
+    const DocumentStatus statuses[] = {DocumentStatus::ACTUAL, DocumentStatus::IRRELEVANT,
+                                       DocumentStatus::BANNED, DocumentStatus::REMOVED};
+    for (int id = 0; id < 1000; ++id) {
+        const std::string text = GenerateText(generator, vocabulary_size, 2, 12);
+        const auto status = statuses[id % 4];
+        server.AddDocument(id, text, status, {id});
+        reference.AddDocument(id, text, status, id);
+    }
+    const auto predicate = [](int document_id, DocumentStatus, int rating) {
+        return document_id % 3 != 0 && rating % 17 > 4;
+    };
+    for (int i = 0; i < 100; ++i) {
+        const std::string query = GenerateReferenceQuery(generator, vocabulary_size, 0.2);
+        std::vector<Document> expected;
+        for (const auto status : statuses) {
+            for (const auto &document : reference.FindTopDocuments(query, status, 1000)) {
+                if (predicate(document.id, status, document.rating)) {
+                    expected.push_back(document);
+                }
+            }
+        }
+        std::sort(expected.begin(), expected.end(), IsMoreRelevant);
+        expected.resize(std::min<size_t>(expected.size(), 10));
+        AssertSameDocuments(server.FindTopDocuments(query, predicate, 10), expected, query);
+    }
+}
+
+} // namespace
+
+void RunScoreAccumulatorTests(TestRunner &tr) {
+    RUN_TEST(tr, TestScoreAccumulatorStates);
+    RUN_TEST(tr, TestScoreAccumulatorClear);
+    RUN_TEST(tr, TestScoreAccumulatorResetWithoutClear);
+    RUN_TEST(tr, TestFindTopDocumentsWithPredicate);
+    RUN_TEST(tr, TestThrowingPredicate);
+}
@@ -0,0 +1,87 @@
+#include "tests.h"
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../merge_policy.h"
+#include "../search_server.h"
+#include "reference_search.h"
+
+namespace {
+
+void TestCheckMergePolicy() {
+    CheckMergePolicy(MergePolicy{});
+    ASSERT_THROWS(CheckMergePolicy(MergePolicy{0, 4, 0.25}), std::invalid_argument);
+    ASSERT_THROWS(CheckMergePolicy(MergePolicy{16, 1, 0.25}), std::invalid_argument);
+    ASSERT_THROWS(CheckMergePolicy(MergePolicy{16, 4, 0.0}), std::invalid_argument);
+    ASSERT_THROWS(CheckMergePolicy(MergePolicy{16, 4, 1.5}), std::invalid_argument);
+}
+
+// Сливаются merge_factor подряд идущих сегментов одного уровня, из нескольких групп - самого низкого
+void TestFindSegmentsToMerge() {
+    const MergePolicy policy{10, 3, 0.25};
+    using Range = std::optional<std::pair<size_t, size_t>>;
+    ASSERT(FindSegmentsToMerge({}, policy) == Range());
+    ASSERT(FindSegmentsToMerge({10, 10}, policy) == Range());
+    ASSERT(FindSegmentsToMerge({10, 10, 10}, policy) == Range({0, 3}));
+    ASSERT(FindSegmentsToMerge({30, 10, 10, 10}, policy) == Range({1, 4}));
+    ASSERT(FindSegmentsToMerge({30, 30, 30, 10, 10, 10}, policy) == Range({3, 6}));
+    ASSERT(FindSegmentsToMerge({30, 30, 30, 10, 10}, policy) == Range({0, 3}));
+    ASSERT(FindSegmentsToMerge({30, 10, 30, 10}, policy) == Range());
+}
+
+void TestFindSegmentToCompact() {
+    const MergePolicy policy{10, 3, 0.25};
+    ASSERT(FindSegmentToCompact({40, 40}, {10, 5}, policy) == std::optional<size_t>());
+    ASSERT(FindSegmentToCompact({40, 40, 10}, {11, 20, 3}, policy) == std::optional<size_t>(1));
+    ASSERT(FindSegmentToCompact({0, 40}, {0, 0}, policy) == std::optional<size_t>());
+}
+
+// Выдача не зависит от того, на какие сегменты разбит индекс и сколько слияний прошло
+void TestSegmentedIndexMatchesReference() {
+    constexpr int vocabulary_size = 150;
+    std::mt19937 generator(12);
+    SearchServer server(std::string("w0"));
+    server.SetMergePolicy({32, 3, 0.25});
+    ReferenceSearch reference("w0");
+    for (int id = 0; id < 3000; ++id) {
+        const std::string text = GenerateText(generator, vocabulary_size, 1, 10);
+        server.AddDocument(id, text, DocumentStatus::ACTUAL, {id});
+        reference.AddDocument(id, text, DocumentStatus::ACTUAL, id);
+        if (id % 500 == 499) {
+            for (int i = 0; i < 20; ++i) {
+                const std::string query = GenerateReferenceQuery(generator, vocabulary_size, 0.2);
+                AssertSameDocuments(server.FindTopDocuments(query), reference.FindTopDocuments(query,
+                                    DocumentStatus::ACTUAL, MAX_RESULT_DOCUMENT_COUNT), query);
+            }
+        }
+    }
+    server.WaitForMerges();
+    // После слияний остаются не больше merge_factor - 1 сегментов каждого уровня
+    ASSERT(server.GetSegmentCount() <= 2 * 5);
+    ASSERT(server.GetSegmentCount() >= 1);
+    for (int i = 0; i < 100; ++i) {
+        const std::string query = GenerateReferenceQuery(generator, vocabulary_size, 0.2);
+        AssertSameDocuments(server.FindTopDocuments(query),
+                            reference.FindTopDocuments(query, DocumentStatus::ACTUAL, MAX_RESULT_DOCUMENT_COUNT),
+                            query);
+    }
+
+    // Смена правил применяется к уже накопленным сегментам
+    server.SetMergePolicy({32, 2, 0.25});
+    server.WaitForMerges();
+    ASSERT(server.GetSegmentCount() <= 7);
+    ASSERT_THROWS(server.SetMergePolicy({0, 2, 0.25}), std::invalid_argument);
+}
+
+} // namespace
+
+void RunSegmentsTests(TestRunner &tr) {
+    RUN_TEST(tr, TestCheckMergePolicy);
+    RUN_TEST(tr, TestFindSegmentsToMerge);
+    RUN_TEST(tr, TestFindSegmentToCompact);
+    RUN_TEST(tr, TestSegmentedIndexMatchesReference);
+}
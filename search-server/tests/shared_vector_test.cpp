@@ -0,0 +1,109 @@
+#include "tests.h"
+
+#include <vector>
+
+#include "../index_segment.h"
+#include "../shared_vector.h"
+
+namespace {
+
+std::vector<int> ToVector(const SharedVector<int> &values) {
+    return {values.begin(), values.end()};
+}
+
+// Копия не видит изменений оригинала, а дописывание за её пределами не копирует буфер
+void TestSharedVectorCopiesAreStable() {
+    SharedVector<int> values;
+    for (int i = 0; i < 10; ++i) {
+        values.push_back(i);
+    }
+    const SharedVector<int> copy = values;
+    values.push_back(10);
+    values.GetMutable(10) = 100;
+    ASSERT_EQUAL(ToVector(copy), std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+    ASSERT_EQUAL(values.size(), 11u);
+    ASSERT_EQUAL(values.back(), 100);
+
+    // Значения, которые видит копия, меняются только в новом буфере
+    values.GetMutable(3) = 30;
+    values.erase(0, 2);
+    values.insert(1, 2, -1);
+    ASSERT_EQUAL(ToVector(values), std::vector<int>({2, -1, -1, 30, 4, 5, 6, 7, 8, 9, 100}));
+    ASSERT_EQUAL(ToVector(copy), std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
+
+void TestSharedVectorAppendsInPlace() {
+    SharedVector<int> values;
+    values.push_back(1);
+    values.push_back(2);
+    const int *data = values.data();
+    size_t copy_count = 0;
+    std::vector<SharedVector<int>> copies;
+    for (int i = 3; i < 1000; ++i) {
+        copies.push_back(values);
+        values.push_back(i);
+        if (values.data() != data) {
+            data = values.data();
+            ++copy_count;
+        }
+    }
+    // Буфер растёт вдвое, поэтому копируется O(log N) раз
+    ASSERT(copy_count < 20);
+    for (size_t i = 0; i < copies.size(); ++i) {
+        ASSERT_EQUAL(copies[i].size(), i + 2);
+        ASSERT_EQUAL(copies[i].back(), static_cast<int>(i + 2));
+    }
+
+    SharedVector<int> moved = std::move(values);
+    ASSERT_EQUAL(moved.size(), 999u);
+    moved.clear();
+    ASSERT(moved.empty());
+    ASSERT_EQUAL(copies.back().size(), 998u);
+}
+
+void TestSharedVectorShrink() {
+    const std::vector<int> first = {1, 2, 3};
+    const std::vector<int> second = {4, 5};
+    SharedVector<int> values;
+    values.assign(first.begin(), first.end());
+    values.append(second.begin(), second.end());
+    const SharedVector<int> copy = values;
+    values.shrink_to_fit();
+    ASSERT_EQUAL(ToVector(values), std::vector<int>({1, 2, 3, 4, 5}));
+    ASSERT_EQUAL(ToVector(copy), std::vector<int>({1, 2, 3, 4, 5}));
+}
+
+// Копия сегмента сохраняет свои документы, пока оригинал пополняется
+void TestIndexSegmentCopyIsStable() {
+    IndexSegment segment(0);
+    for (int slot = 0; slot < 300; ++slot) {
+        segment.AddDocument(1.0 / (slot + 1));
+        segment.AddTerm(0).Add(slot, 1, 1.0 / (slot + 1));
+    }
+    const IndexSegment copy = segment;
+    for (int slot = 300; slot < 700; ++slot) {
+        segment.AddDocument(1.0);
+        segment.AddTerm(0).Add(slot, 2, 2.0);
+        segment.AddTerm(1).Add(slot, 1, 1.0);
+    }
+    ASSERT_EQUAL(copy.GetLastSlot(), 300);
+    ASSERT_EQUAL(copy.GetPostings(0).size(), 300u);
+    ASSERT(copy.GetPostings(1).empty());
+    ASSERT_EQUAL(segment.GetPostings(0).size(), 700u);
+    int slot = 0;
+    for (PostingList::Cursor cursor(copy.GetPostings(0), copy.GetInverseWordCounts()); !cursor.IsEnd();
+         cursor.Next(), ++slot) {
+        ASSERT_EQUAL(cursor.GetDocumentId(), slot);
+        ASSERT_EQUAL(cursor.GetTermFreq(), 1.0 / (slot + 1));
+    }
+    ASSERT_EQUAL(slot, 300);
+}
+
+} // namespace
+
+void RunSharedVectorTests(TestRunner &tr) {
+    RUN_TEST(tr, TestSharedVectorCopiesAreStable);
+    RUN_TEST(tr, TestSharedVectorAppendsInPlace);
+    RUN_TEST(tr, TestSharedVectorShrink);
+    RUN_TEST(tr, TestIndexSegmentCopyIsStable);
+}
@@ -0,0 +1,29 @@
+#include "tests.h"
+
+int main() {
+    TestRunner tr;
+    RunPostingListTests(tr);
+    RunLexiconTests(tr);
+    RunTopDocumentsTests(tr);
+    RunMaxScoreTests(tr);
+    RunScoreAccumulatorTests(tr);
+    RunParallelSearchTests(tr);
+    RunCollectionStatisticsTests(tr);
+    RunBitPackingTests(tr);
+    RunTokenizerTests(tr);
+    RunAddDocumentsTests(tr);
+    RunSharedVectorTests(tr);
+    RunSegmentsTests(tr);
+    RunConcurrentReadsTests(tr);
+    RunRemoveDocumentsTests(tr);
+    RunIndexSnapshotTests(tr);
+    RunMappedSearchServerTests(tr);
+    RunTextArenaTests(tr);
+    RunQueryCacheTests(tr);
+    RunThreadPoolTests(tr);
+    RunQueryBatchTests(tr);
+    RunProcessQueriesTests(tr);
+    RunRemoveDuplicatesTests(tr);
+    RunDuplicatePolicyTests(tr);
+    RunRequestStatisticsTests(tr);
+}
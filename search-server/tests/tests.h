@@ -0,0 +1,52 @@
+#pragma once
+
+#include "../test_framework.h"
+
+// Наборы тестов компонентов сервера. Каждый запускает свои тест-функции через RUN_TEST
+void RunPostingListTests(TestRunner &tr);
+
+void RunLexiconTests(TestRunner &tr);
+
+void RunTopDocumentsTests(TestRunner &tr);
+
+void RunMaxScoreTests(TestRunner &tr);
+
+void RunScoreAccumulatorTests(TestRunner &tr);
+
+void RunParallelSearchTests(TestRunner &tr);
+
+void RunCollectionStatisticsTests(TestRunner &tr);
+
+void RunBitPackingTests(TestRunner &tr);
+
+void RunTokenizerTests(TestRunner &tr);
+
+void RunAddDocumentsTests(TestRunner &tr);
+
+void RunSharedVectorTests(TestRunner &tr);
+
+void RunSegmentsTests(TestRunner &tr);
+
+void RunConcurrentReadsTests(TestRunner &tr);
+
+void RunRemoveDocumentsTests(TestRunner &tr);
+
+void RunIndexSnapshotTests(TestRunner &tr);
+
+void RunMappedSearchServerTests(TestRunner &tr);
+
+void RunTextArenaTests(TestRunner &tr);
+
+void RunQueryCacheTests(TestRunner &tr);
+
+void RunThreadPoolTests(TestRunner &tr);
+
+void RunQueryBatchTests(TestRunner &tr);
+
+void RunProcessQueriesTests(TestRunner &tr);
+
+void RunRemoveDuplicatesTests(TestRunner &tr);
+
+void RunDuplicatePolicyTests(TestRunner &tr);
+
+void RunRequestStatisticsTests(TestRunner &tr);
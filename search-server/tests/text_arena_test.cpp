@@ -0,0 +1,88 @@
+#include "tests.h"
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../allocation_options.h"
+#include "../search_server.h"
+#include "../text_arena.h"
+
+namespace {
+
+// Копии строк не перемещаются при добавлении новых, длинная строка получает отдельный буфер
+void TestTextArenaKeepsCopies() {
+    TextArena arena(16);
+    ASSERT_EQUAL(arena.GetChunkSize(), 16u);
+    std::vector<std::string> texts;
+    std::vector<std::string_view> copies;
+    for (int i = 0; i < 100; ++i) {
+        texts.push_back(std::string(i % 7, 'a' + i % 26) + std::to_string(i));
+        if (i % 10 == 0) {
+            texts.back() += std::string(40, 'z');
+        }
+        copies.push_back(arena.Add(texts.back()));
+        ASSERT(copies.back().data() != texts.back().data());
+    }
+    size_t size = 0;
+    for (size_t i = 0; i < texts.size(); ++i) {
+        ASSERT_EQUAL(copies[i], texts[i]);
+        size += texts[i].size();
+    }
+    ASSERT_EQUAL(arena.GetSize(), size);
+    ASSERT_EQUAL(arena.Add(""), "");
+
+    arena.Clear();
+    ASSERT_EQUAL(arena.GetSize(), 0u);
+    ASSERT_EQUAL(arena.Add("after clear"), "after clear");
+    ASSERT_THROWS(TextArena(0), std::invalid_argument);
+}
+
+void TestAllocationOptions() {
+    CheckAllocationOptions({});
+    ASSERT_EQUAL(AllocationOptions{}.text_chunk_size, TextArena::DEFAULT_CHUNK_SIZE);
+    ASSERT_THROWS(CheckAllocationOptions({AllocationStrategy::POOL, 0}), std::invalid_argument);
+    ASSERT_THROWS(CheckAllocationOptions({static_cast<AllocationStrategy>(10), 16}), std::invalid_argument);
+    ASSERT(MakeMemoryResource({AllocationStrategy::HEAP, 16}) == nullptr);
+    ASSERT(MakeMemoryResource({AllocationStrategy::POOL, 16}) != nullptr);
+    ASSERT(MakeMemoryResource({AllocationStrategy::MONOTONIC, 16}) != nullptr);
+    ASSERT_THROWS(SearchServer(std::string("and"), {AllocationStrategy::POOL, 0}), std::invalid_argument);
+}
+
+// Стратегия выделения памяти не меняет ответов сервера, в том числе после удалений
+// и переписывания текстов документов
+void TestAllocationStrategiesGiveSameResults() {
+    std::vector<std::vector<Document>> results;
+    std::vector<std::map<TermId, double>> word_freqs;
+    for (const auto strategy : {AllocationStrategy::HEAP, AllocationStrategy::POOL, AllocationStrategy::MONOTONIC}) {
+        SearchServer server(std::string("and with"), {strategy, 32});
+        for (int id = 0; id < 200; ++id) {
+            server.AddDocument(id, "cat number" + std::to_string(id % 13) + " and dog" + std::to_string(id % 7),
+                               DocumentStatus::ACTUAL, {id});
+            if (id % 3 == 0) {
+                server.RemoveDocument(id / 2);
+            }
+        }
+        results.push_back(server.FindTopDocuments("cat dog3 -number5"));
+        const auto &freqs = server.GetWordFrequencies(199);
+        word_freqs.emplace_back(freqs.begin(), freqs.end());
+    }
+    for (size_t i = 1; i < results.size(); ++i) {
+        ASSERT_EQUAL(results[i].size(), results[0].size());
+        for (size_t j = 0; j < results[i].size(); ++j) {
+            ASSERT_EQUAL(results[i][j].id, results[0][j].id);
+        }
+        ASSERT(word_freqs[i] == word_freqs[0]);
+    }
+    ASSERT(!results[0].empty());
+}
+
+} // namespace
+
+void RunTextArenaTests(TestRunner &tr) {
+    RUN_TEST(tr, TestTextArenaKeepsCopies);
+    RUN_TEST(tr, TestAllocationOptions);
+    RUN_TEST(tr, TestAllocationStrategiesGiveSameResults);
+}
@@ -0,0 +1,105 @@
+#include "tests.h"
+
+#include <atomic>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../process_queries.h"
+#include "../search_server.h"
+#include "../thread_pool.h"
+#include "reference_search.h"
+
+namespace {
+
+// Каждая задача пакета выполняется ровно один раз, пул переиспользуется следующими пакетами
+void TestThreadPoolRunsEveryTask() {
+    ThreadPool pool(3);
+    ASSERT_EQUAL(pool.GetWorkerCount(), 3u);
+    for (int batch = 0; batch < 20; ++batch) {
+        // Каждая задача пишет в свой счётчик, Run дожидается записей
+        std::vector<int> counters(100 + batch);
+        std::vector<std::function<void()>> tasks;
+        for (auto &counter : counters) {
+            tasks.emplace_back([&counter] {
+                ++counter;
+            });
+        }
+        pool.Run(std::move(tasks));
+        for (const int counter : counters) {
+            ASSERT_EQUAL(counter, 1);
+        }
+    }
+    pool.Run({});
+    ASSERT_THROWS(ThreadPool(0), std::invalid_argument);
+}
+
+// Задача может запустить вложенный пакет на том же пуле, исключение задачи доходит до Run
+void TestThreadPoolNestedRunAndErrors() {
+    ThreadPool pool(2);
+    std::atomic<int> count{0};
+    std::vector<std::function<void()>> tasks;
+    for (int i = 0; i < 4; ++i) {
+        tasks.emplace_back([&pool, &count] {
+            std::vector<std::function<void()>> nested;
+            for (int j = 0; j < 8; ++j) {
+                nested.emplace_back([&count] {
+                    count.fetch_add(1);
+                });
+            }
+            pool.Run(std::move(nested));
+        });
+    }
+    pool.Run(std::move(tasks));
+    ASSERT_EQUAL(count.load(), 32);
+
+    std::atomic<int> finished{0};
+    std::vector<std::function<void()>> failing;
+    for (int i = 0; i < 10; ++i) {
+        failing.emplace_back([i, &finished] {
+            if (i == 3) {
+                throw std::runtime_error("task failed");
+            }
+            finished.fetch_add(1);
+        });
+    }
+    ASSERT_THROWS(pool.Run(std::move(failing)), std::runtime_error);
+    ASSERT_EQUAL(finished.load(), 9);
+}
+
+// Пакетное выполнение на пулах разного размера даёт те же результаты, что и запросы по одному,
+// в том числе для пустого пакета и пакета из одного тяжёлого запроса среди лёгких
+void TestProcessQueriesInPoolMatchesSequential() {
+    constexpr int vocabulary_size = 200;
+    std::mt19937 generator(19);
+    SearchServer server(std::string("w0"));
+    for (int id = 0; id < 3000; ++id) {
+        server.AddDocument(id, GenerateText(generator, vocabulary_size, 1, 10), DocumentStatus::ACTUAL, {id});
+    }
+    std::vector<std::string> queries;
+    for (int i = 0; i < 300; ++i) {
+        queries.push_back(GenerateReferenceQuery(generator, vocabulary_size, 0.2));
+    }
+    queries[150] = "w1 w2 w3 w4 w5 w6 w7 w8 w9 w10 w11 w12";
+
+    for (const size_t worker_count : {1u, 2u, 5u}) {
+        ThreadPool pool(worker_count);
+        ASSERT(ProcessQueriesInPool(pool, server, {}).empty());
+        const auto results = ProcessQueriesInPool(pool, server, queries);
+        ASSERT_EQUAL(results.size(), queries.size());
+        for (size_t i = 0; i < queries.size(); ++i) {
+            AssertSameDocuments(results[i], server.FindTopDocuments(queries[i]), queries[i]);
+        }
+    }
+    ASSERT_THROWS(ProcessQueries(server, {"w1 --w2"}), std::invalid_argument);
+}
+
+} // namespace
+
+void RunThreadPoolTests(TestRunner &tr) {
+    RUN_TEST(tr, TestThreadPoolRunsEveryTask);
+    RUN_TEST(tr, TestThreadPoolNestedRunAndErrors);
+    RUN_TEST(tr, TestProcessQueriesInPoolMatchesSequential);
+}
@@ -0,0 +1,99 @@
+#include "tests.h"
+
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../string_processing.h"
+#include "../tokenizer.h"
+
+namespace {
+
+std::vector<std::string_view> SplitWithoutStopWords(std::string_view text, const std::set<std::string> &stop_words) {
+    std::vector<std::string_view> words;
+    for (const auto word : SplitIntoWords(text)) {
+        if (stop_words.count(std::string(word)) == 0) {
+            words.push_back(word);
+        }
+    }
+    return words;
+}
+
+void TestTokenizerSplitsLikeSplitIntoWords() {
+    const std::set<std::string> stop_words = {"and", "in", "on", "a"};
+    const Tokenizer tokenizer(stop_words);
+    std::vector<std::string_view> words;
+    for (const std::string text : {"", " ", "cat", "a cat and  a dog in the city ", "  and",
+                                   "averyveryverylongwordthatcrossesseveralsixteenbyteblocks in on"}) {
+        tokenizer.Split(text, words);
+        ASSERT_EQUAL(words, SplitWithoutStopWords(text, stop_words));
+    }
+}
+
+// Случайные тексты со словами разной длины, пробелами подряд и байтами вне ASCII
+void TestTokenizerMatchesOnRandomTexts() {
+    std::mt19937 generator(10);
+    const std::string alphabet = "ab \xD0\xB0-";
+    std::set<std::string> stop_words;
+    for (int i = 0; i < 50; ++i) {
+        stop_words.insert(std::string(static_cast<size_t>(i % 5 + 1), static_cast<char>('a' + i % 2)) +
+                          std::to_string(i));
+    }
+    stop_words.insert("a");
+    stop_words.insert("ab");
+    const Tokenizer tokenizer(stop_words);
+    std::vector<std::string_view> words;
+    for (int i = 0; i < 2000; ++i) {
+        std::string text(std::uniform_int_distribution<size_t>(0, 70)(generator), ' ');
+        for (auto &c : text) {
+            c = alphabet[std::uniform_int_distribution<size_t>(0, alphabet.size() - 1)(generator)];
+        }
+        tokenizer.Split(text, words);
+        AssertEqual(words, SplitWithoutStopWords(text, stop_words), text);
+    }
+}
+
+void TestTokenizerStopWords() {
+    std::set<std::string> stop_words;
+    for (int i = 0; i < 1000; ++i) {
+        stop_words.insert("stop" + std::to_string(i));
+    }
+    const Tokenizer tokenizer(stop_words);
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT(tokenizer.IsStopWord("stop" + std::to_string(i)));
+        ASSERT(!tokenizer.IsStopWord("stop" + std::to_string(i + 1000)));
+    }
+    ASSERT(!tokenizer.IsStopWord(""));
+    ASSERT(!tokenizer.IsStopWord("stop"));
+    ASSERT_EQUAL(tokenizer.GetStopWords().size(), 1000u);
+
+    const Tokenizer empty_tokenizer({});
+    ASSERT(!empty_tokenizer.IsStopWord("stop1"));
+}
+
+// Спецсимвол находится в любой позиции относительно 16-байтовых блоков
+void TestTokenizerRejectsControlCharacters() {
+    const Tokenizer tokenizer({"in"});
+    std::vector<std::string_view> words;
+    for (size_t position = 0; position < 40; ++position) {
+        for (const char c : {'\x01', '\t', '\x1F'}) {
+            std::string text(40, 'x');
+            text[position] = c;
+            ASSERT_THROWS(tokenizer.Split(text, words), std::invalid_argument);
+        }
+    }
+    tokenizer.Split(std::string(40, '\x7F'), words);
+    ASSERT_EQUAL(words.size(), 1u);
+}
+
+} // namespace
+
+void RunTokenizerTests(TestRunner &tr) {
+    RUN_TEST(tr, TestTokenizerSplitsLikeSplitIntoWords);
+    RUN_TEST(tr, TestTokenizerMatchesOnRandomTexts);
+    RUN_TEST(tr, TestTokenizerStopWords);
+    RUN_TEST(tr, TestTokenizerRejectsControlCharacters);
+}
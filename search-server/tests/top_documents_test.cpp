@@ -0,0 +1,87 @@
+#include "tests.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../search_server.h"
+#include "../top_documents.h"
+
+namespace {
+
+std::vector<int> GetIds(const std::vector<Document> &documents) {
+    std::vector<int> ids;
+    for (const auto &document : documents) {
+        ids.push_back(document.id);
+    }
+    return ids;
+}
+
+// Ограниченная куча даёт то же, что сортировка всех документов и отсечение
+void TestTopDocumentsMatchesFullSort() {
+    std::mt19937 generator(7);
+    for (const size_t capacity : {0u, 1u, 5u, 64u}) {
+        std::vector<Document> documents;
+        TopDocuments top_documents(capacity);
+        for (int id = 0; id < 500; ++id) {
+            // Различные рейтинги делают порядок однозначным и при равных релевантностях
+            const Document document(id, std::uniform_int_distribution(0, 20)(generator) * 0.1, id);
+            documents.push_back(document);
+            top_documents.Add(document);
+        }
+        std::sort(documents.begin(), documents.end(), IsMoreRelevant);
+        documents.resize(std::min(documents.size(), capacity));
+        ASSERT_EQUAL(GetIds(top_documents.Extract()), GetIds(documents));
+    }
+}
+
+// Куча в буфере вызывающего отбирает те же документы, что и в своём векторе
+void TestTopDocumentsInBuffer() {
+    std::mt19937 generator(8);
+    for (const size_t capacity : {0u, 1u, 5u, 64u}) {
+        std::vector<Document> buffer(capacity);
+        TopDocuments in_buffer(buffer.data(), capacity);
+        TopDocuments in_vector(capacity);
+        for (int id = 0; id < 500; ++id) {
+            const Document document(id, std::uniform_int_distribution(0, 20)(generator) * 0.1, id);
+            in_buffer.Add(document);
+            in_vector.Add(document);
+        }
+        ASSERT_EQUAL(in_buffer.GetCapacity(), capacity);
+        buffer.resize(in_buffer.SortBuffer());
+        ASSERT_EQUAL(GetIds(buffer), GetIds(in_vector.Extract()));
+    }
+}
+
+void TestTopDocumentsThreshold() {
+    TopDocuments top_documents(2);
+    ASSERT(top_documents.GetThreshold() < -1e300);
+    top_documents.Add({1, 0.5, 0});
+    top_documents.Add({2, 0.9, 0});
+    ASSERT(top_documents.IsFull());
+    ASSERT(top_documents.GetThreshold() < 0.5 && top_documents.GetThreshold() > 0.49);
+    top_documents.Add({3, 0.7, 0});
+    ASSERT_EQUAL(GetIds(top_documents.Extract()), std::vector<int>({2, 3}));
+}
+
+void TestFindTopDocumentsTopCount() {
+    SearchServer server(std::string("and"));
+    for (int id = 0; id < 20; ++id) {
+        server.AddDocument(id, "cat " + std::string(static_cast<size_t>(id) + 1, 'x'), DocumentStatus::ACTUAL, {id});
+    }
+    ASSERT_EQUAL(server.FindTopDocuments("cat").size(), static_cast<size_t>(MAX_RESULT_DOCUMENT_COUNT));
+    ASSERT_EQUAL(server.FindTopDocuments("cat", DocumentStatus::ACTUAL, 12).size(), 12u);
+    ASSERT_EQUAL(server.FindTopDocuments("cat", DocumentStatus::ACTUAL, 100).size(), 20u);
+    ASSERT(server.FindTopDocuments("cat", DocumentStatus::ACTUAL, 0).empty());
+    // Все документы одинаково релевантны, поэтому первыми идут документы с большим рейтингом
+    ASSERT_EQUAL(GetIds(server.FindTopDocuments("cat", DocumentStatus::ACTUAL, 3)), std::vector<int>({19, 18, 17}));
+}
+
+} // namespace
+
+void RunTopDocumentsTests(TestRunner &tr) {
+    RUN_TEST(tr, TestTopDocumentsMatchesFullSort);
+    RUN_TEST(tr, TestTopDocumentsInBuffer);
+    RUN_TEST(tr, TestTopDocumentsThreshold);
+    RUN_TEST(tr, TestFindTopDocumentsTopCount);
+}
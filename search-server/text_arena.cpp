@@ -0,0 +1,49 @@
+#include "text_arena.h"
+
+#include <cstring>
+#include <stdexcept>
+
+TextArena::TextArena(size_t chunk_size)
+        : chunk_size_(chunk_size) {
+    if (chunk_size_ == 0) {
+        throw std::invalid_argument("Invalid text arena chunk size");
+    }
+}
+
+std::string_view TextArena::Add(std::string_view text) {
+    if (text.empty()) {
+        return {};
+    }
+    size_ += text.size();
+    if (text.size() > chunk_size_) {
+        // Отдельный буфер вставляется перед последним, чтобы не терять его свободное место
+        auto &chunk = *chunks_.insert(chunks_.end() - (chunks_.empty() ? 0 : 1),
+                                      std::make_unique<char[]>(text.size()));
+        std::memcpy(chunk.get(), text.data(), text.size());
+        return {chunk.get(), text.size()};
+    }
+    if (text.size() > free_size_) {
+        free_ = chunks_.emplace_back(std::make_unique<char[]>(chunk_size_)).get();
+        free_size_ = chunk_size_;
+    }
+    char *const data = free_;
+    std::memcpy(data, text.data(), text.size());
+    free_ += text.size();
+    free_size_ -= text.size();
+    return {data, text.size()};
+}
+
+size_t TextArena::GetSize() const {
+    return size_;
+}
+
+size_t TextArena::GetChunkSize() const {
+    return chunk_size_;
+}
+
+void TextArena::Clear() {
+    chunks_.clear();
+    free_ = nullptr;
+    free_size_ = 0;
+    size_ = 0;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Хранилище строк в больших буферах. Строки копируются подряд в буферы по chunk_size байт,
+// строка длиннее буфера получает отдельный буфер. Строки не перемещаются и по одной
+// не освобождаются: память возвращается вся сразу при Clear или уничтожении хранилища
+class TextArena {
+public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+    // Бросит std::invalid_argument, если chunk_size равен нулю
+    explicit TextArena(size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+    // Скопирует текст в хранилище. Копия действительна до Clear или уничтожения хранилища
+    std::string_view Add(std::string_view text);
+
+    // Суммарная длина сохранённых строк
+    size_t GetSize() const;
+
+    size_t GetChunkSize() const;
+
+    void Clear();
+
+private:
+    size_t chunk_size_;
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    char *free_ = nullptr; // Свободное место в последнем буфере
+    size_t free_size_ = 0;
+    size_t size_ = 0;
+};
@@ -0,0 +1,133 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+ThreadPool::ThreadPool(size_t worker_count) {
+    if (worker_count == 0) {
+        throw std::invalid_argument("Thread pool needs at least one worker");
+    }
+    queues_.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    workers_.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers_.emplace_back([this, i] {
+            Work(i);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard guard(wake_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::GetWorkerCount() const {
+    return workers_.size();
+}
+
+void ThreadPool::Run(std::vector<std::function<void()>> tasks) {
+    if (tasks.empty()) {
+        return;
+    }
+    Batch batch;
+    batch.remaining = tasks.size();
+    {
+        // Пакеты из разных потоков раздаются под одной блокировкой, чтобы не делить next_queue_
+        std::lock_guard guard(wake_mutex_);
+        for (auto &function : tasks) {
+            auto &queue = *queues_[next_queue_];
+            next_queue_ = (next_queue_ + 1) % queues_.size();
+            std::lock_guard queue_guard(queue.mutex);
+            queue.tasks.push_back({std::move(function), &batch});
+        }
+        queued_.fetch_add(tasks.size());
+    }
+    wake_.notify_all();
+
+    Task task;
+    while (TryTake(0, task)) {
+        Execute(task);
+    }
+    std::unique_lock lock(batch.mutex);
+    batch.done.wait(lock, [&batch] {
+        return batch.remaining == 0;
+    });
+    if (batch.error) {
+        std::rethrow_exception(batch.error);
+    }
+}
+
+void ThreadPool::Work(size_t worker) {
+    Task task;
+    while (true) {
+        if (TryTake(worker, task)) {
+            Execute(task);
+            continue;
+        }
+        std::unique_lock lock(wake_mutex_);
+        wake_.wait(lock, [this] {
+            return stop_ || queued_.load() > 0;
+        });
+        if (stop_ && queued_.load() == 0) {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::TryTake(size_t first_queue, Task &task) {
+    if (queued_.load() == 0) {
+        return false;
+    }
+    for (size_t i = 0; i < queues_.size(); ++i) {
+        auto &queue = *queues_[(first_queue + i) % queues_.size()];
+        std::lock_guard guard(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        // Своя очередь - с начала, чужая - с конца, чтобы реже мешать её владельцу
+        if (i == 0) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        } else {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        queued_.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::Execute(Task &task) {
+    std::exception_ptr error;
+    try {
+        task.function();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    task.function = nullptr;
+    // Пакет может быть уничтожен сразу после того, как счётчик обнулится и блокировка освободится,
+    // поэтому оповещение отправляется под блокировкой
+    std::lock_guard guard(task.batch->mutex);
+    if (error && !task.batch->error) {
+        task.batch->error = error;
+    }
+    if (--task.batch->remaining == 0) {
+        task.batch->done.notify_all();
+    }
+}
+
+ThreadPool &GetQueryThreadPool(size_t worker_count) {
+    static ThreadPool pool(worker_count != 0 ? worker_count
+                                             : std::max<size_t>(1, std::thread::hardware_concurrency()));
+    return pool;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков с перехватом работы. У каждого потока своя очередь задач: поток берёт
+// задачи из начала своей очереди, а когда она пуста - из конца очередей других потоков.
+// Потоки создаются один раз в конструкторе и переиспользуются всеми пакетами задач
+class ThreadPool {
+public:
+    // Бросит std::invalid_argument, если worker_count равен нулю
+    explicit ThreadPool(size_t worker_count);
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Дождётся завершения задач и остановит потоки
+    ~ThreadPool();
+
+    size_t GetWorkerCount() const;
+
+    // Выполнит пакет задач и дождётся их завершения. Задачи раздаются очередям потоков
+    // по кругу в порядке пакета, поэтому первые задачи начинаются первыми.
+    // Вызывающий поток тоже выполняет задачи, пока они есть, поэтому Run можно вызывать
+    // и из задачи пула. Если задачи бросили исключения, после завершения пакета
+    // пробрасывается одно из них
+    void Run(std::vector<std::function<void()>> tasks);
+
+private:
+    // Счётчик невыполненных задач пакета. Живёт в стеке Run, пока счётчик не обнулится
+    struct Batch {
+        std::mutex mutex;
+        std::condition_variable done;
+        size_t remaining = 0;
+        std::exception_ptr error;
+    };
+
+    struct Task {
+        std::function<void()> function;
+        Batch *batch;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_; // По очереди на поток
+    std::vector<std::thread> workers_;
+    size_t next_queue_ = 0; // Очередь для первой задачи следующего пакета
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> queued_{0}; // Задачи в очередях, увеличивается под wake_mutex_
+    bool stop_ = false;
+
+    void Work(size_t worker);
+
+    // Возьмёт задачу из очереди first_queue или перехватит из других очередей
+    bool TryTake(size_t first_queue, Task &task);
+
+    static void Execute(Task &task);
+};
+
+// Общий пул для параллельной обработки запросов. Создаётся при первом обращении
+// с worker_count потоками, 0 - по числу ядер. При следующих обращениях worker_count не учитывается
+ThreadPool &GetQueryThreadPool(size_t worker_count = 0);
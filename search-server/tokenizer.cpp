@@ -0,0 +1,149 @@
+#include "tokenizer.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+Tokenizer::Tokenizer(const std::set<std::string> &stop_words)
+        : stop_words_(stop_words.begin(), stop_words.end()) {
+    if (stop_words_.empty()) {
+        return;
+    }
+    size_t bucket_count = 1;
+    while (bucket_count < stop_words_.size()) {
+        bucket_count *= 2;
+    }
+    bucket_seeds_.assign(bucket_count, 0);
+    bucket_mask_ = bucket_count - 1;
+    size_t slot_count = 2 * bucket_count;
+    while (!BuildSlots(slot_count)) {
+        slot_count *= 2;
+    }
+}
+
+void Tokenizer::Split(std::string_view text, std::vector<std::string_view> &words) const {
+    words.clear();
+    const auto add_word = [this, &words, text](size_t begin, size_t end) {
+        const std::string_view word = text.substr(begin, end - begin);
+        if (!IsStopWord(word)) {
+            words.push_back(word);
+        }
+    };
+    const auto throw_special_character = [] {
+        throw std::invalid_argument("Special character detected");
+    };
+
+    size_t word_begin = 0;
+    size_t pos = 0;
+#ifdef __SSE2__
+    const __m128i spaces = _mm_set1_epi8(' ');
+    const __m128i zeros = _mm_setzero_si128();
+    for (; pos + 16 <= text.size(); pos += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text.data() + pos));
+        // Спецсимволы - байты от 0 до 31: меньше пробела и не отрицательные как знаковые
+        const __m128i special = _mm_andnot_si128(_mm_cmplt_epi8(chunk, zeros), _mm_cmplt_epi8(chunk, spaces));
+        if (_mm_movemask_epi8(special) != 0) {
+            throw_special_character();
+        }
+        auto space_mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, spaces)));
+        while (space_mask != 0) {
+            const size_t space_pos = pos + static_cast<size_t>(__builtin_ctz(space_mask));
+            add_word(word_begin, space_pos);
+            word_begin = space_pos + 1;
+            space_mask &= space_mask - 1;
+        }
+    }
+#endif
+    for (; pos < text.size(); ++pos) {
+        const char c = text[pos];
+        if (c >= '\0' && c < ' ') {
+            throw_special_character();
+        }
+        if (c == ' ') {
+            add_word(word_begin, pos);
+            word_begin = pos + 1;
+        }
+    }
+    add_word(word_begin, text.size());
+}
+
+bool Tokenizer::IsStopWord(std::string_view word) const {
+    if (slots_.empty()) {
+        return false;
+    }
+    const uint32_t seed = bucket_seeds_[Hash(word, 0) & bucket_mask_];
+    const uint32_t slot = slots_[Hash(word, seed) & slot_mask_];
+    return slot != 0 && stop_words_[slot - 1] == word;
+}
+
+const std::vector<std::string> &Tokenizer::GetStopWords() const {
+    return stop_words_;
+}
+
+uint64_t Tokenizer::Hash(std::string_view word, uint32_t seed) {
+    // FNV-1a с зерном в начальном состоянии и финальным перемешиванием splitmix64,
+    // чтобы младшие биты зависели от всех символов
+    uint64_t hash = 0xcbf29ce484222325ULL ^ (seed * 0x9e3779b97f4a7c15ULL);
+    for (const char c : word) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+bool Tokenizer::BuildSlots(size_t slot_count) {
+    constexpr uint32_t MAX_SEED = 1 << 16;
+
+    slots_.assign(slot_count, 0);
+    slot_mask_ = slot_count - 1;
+    std::vector<std::vector<uint32_t>> buckets(bucket_seeds_.size());
+    for (uint32_t i = 0; i < stop_words_.size(); ++i) {
+        buckets[Hash(stop_words_[i], 0) & bucket_mask_].push_back(i);
+    }
+    // Большие корзины размещаются первыми, пока свободных ячеек много
+    std::vector<size_t> order(buckets.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&buckets](size_t lhs, size_t rhs) {
+        return buckets[lhs].size() > buckets[rhs].size();
+    });
+
+    std::vector<uint64_t> bucket_slots;
+    for (const size_t bucket : order) {
+        const auto &word_indexes = buckets[bucket];
+        if (word_indexes.empty()) {
+            break;
+        }
+        uint32_t seed = 1;
+        for (; seed < MAX_SEED; ++seed) {
+            bucket_slots.clear();
+            for (const uint32_t word_index : word_indexes) {
+                const uint64_t slot = Hash(stop_words_[word_index], seed) & slot_mask_;
+                if (slots_[slot] != 0
+                    || std::find(bucket_slots.begin(), bucket_slots.end(), slot) != bucket_slots.end()) {
+                    break;
+                }
+                bucket_slots.push_back(slot);
+            }
+            if (bucket_slots.size() == word_indexes.size()) {
+                break;
+            }
+        }
+        if (seed == MAX_SEED) {
+            return false;
+        }
+        bucket_seeds_[bucket] = seed;
+        for (size_t i = 0; i < word_indexes.size(); ++i) {
+            slots_[bucket_slots[i]] = word_indexes[i] + 1;
+        }
+    }
+    return true;
+}
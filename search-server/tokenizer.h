@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Разбор текста документа на слова за один проход: поиск пробелов, проверка
+// на спецсимволы и отбрасывание стоп-слов. Текст просматривается по 16 байт
+// SSE2-командами, без SSE2 - побайтово.
+// Стоп-слова ищутся по совершенной хеш-таблице, построенной в конструкторе:
+// у каждого слова своя ячейка, и поиск - два хеширования и одно сравнение строк без выделения памяти.
+class Tokenizer {
+public:
+    explicit Tokenizer(const std::set<std::string> &stop_words);
+
+    // Заменит содержимое words словами текста, кроме стоп-слов. Как и SplitIntoWords,
+    // разделяет текст по каждому пробелу, поэтому подряд идущие пробелы дают пустые слова.
+    // Бросит std::invalid_argument, если в тексте есть спецсимволы (коды 0-31)
+    void Split(std::string_view text, std::vector<std::string_view> &words) const;
+
+    bool IsStopWord(std::string_view word) const;
+
+    const std::vector<std::string> &GetStopWords() const;
+
+private:
+    std::vector<std::string> stop_words_;
+    std::vector<uint32_t> bucket_seeds_; // Зерно хеша ячейки для каждой корзины
+    std::vector<uint32_t> slots_; // Номер стоп-слова + 1 или 0 для пустой ячейки
+    uint64_t bucket_mask_ = 0;
+    uint64_t slot_mask_ = 0;
+
+    static uint64_t Hash(std::string_view word, uint32_t seed);
+
+    // Подберёт зёрна корзин для таблицы из slot_count ячеек. Вернёт false, если не удалось
+    bool BuildSlots(size_t slot_count);
+};
@@ -0,0 +1,72 @@
+#include "top_documents.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+TopDocuments::TopDocuments(size_t capacity)
+        : capacity_(capacity) {
+}
+
+TopDocuments::TopDocuments(Document *buffer, size_t capacity)
+        : capacity_(capacity), buffer_(buffer) {
+}
+
+size_t TopDocuments::GetCapacity() const {
+    return capacity_;
+}
+
+bool TopDocuments::IsFull() const {
+    return size() >= capacity_;
+}
+
+double TopDocuments::GetThreshold() const {
+    if (!IsFull()) {
+        return -std::numeric_limits<double>::infinity();
+    }
+    if (size() == 0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return GetHeapBegin()->relevance - 2 * EPSILON;
+}
+
+void TopDocuments::Add(const Document &document) {
+    if (!IsFull()) {
+        if (buffer_ == nullptr) {
+            heap_.push_back(document);
+        } else {
+            buffer_[buffer_size_++] = document;
+        }
+        std::push_heap(GetHeapBegin(), GetHeapBegin() + size(), IsMoreRelevant);
+        return;
+    }
+    Document *heap = GetHeapBegin();
+    if (size() == 0 || !IsMoreRelevant(document, *heap)) {
+        return;
+    }
+    std::pop_heap(heap, heap + size(), IsMoreRelevant);
+    heap[size() - 1] = document;
+    std::push_heap(heap, heap + size(), IsMoreRelevant);
+}
+
+std::vector<Document> TopDocuments::Extract() {
+    std::sort_heap(heap_.begin(), heap_.end(), IsMoreRelevant);
+    return std::move(heap_);
+}
+
+size_t TopDocuments::SortBuffer() {
+    std::sort_heap(buffer_, buffer_ + buffer_size_, IsMoreRelevant);
+    return buffer_size_;
+}
+
+size_t TopDocuments::size() const {
+    return buffer_ == nullptr ? heap_.size() : buffer_size_;
+}
+
+Document *TopDocuments::GetHeapBegin() {
+    return buffer_ == nullptr ? heap_.data() : buffer_;
+}
+
+const Document *TopDocuments::GetHeapBegin() const {
+    return buffer_ == nullptr ? heap_.data() : buffer_;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "document.h"
+
+// Ограниченная куча лучших документов в порядке IsMoreRelevant.
+// Хранит не больше capacity документов, в вершине кучи - худший из них.
+// Куча лежит в своём векторе или в буфере вызывающего на capacity документов
+class TopDocuments {
+public:
+    explicit TopDocuments(size_t capacity);
+
+    // Куча в буфере buffer, который переживает объект
+    TopDocuments(Document *buffer, size_t capacity);
+
+    size_t GetCapacity() const;
+
+    bool IsFull() const;
+
+    // Документ с релевантностью ниже порога в выдачу уже не попадёт.
+    // Порог взят с запасом, т.к. релевантности в пределах EPSILON сравниваются по рейтингу
+    double GetThreshold() const;
+
+    void Add(const Document &document);
+
+    // Вернёт накопленные документы в порядке выдачи. Только для кучи в своём векторе
+    std::vector<Document> Extract();
+
+    // Упорядочит документы в буфере в порядке выдачи и вернёт их число
+    size_t SortBuffer();
+
+private:
+    size_t capacity_;
+    std::vector<Document> heap_;
+    Document *buffer_ = nullptr;
+    size_t buffer_size_ = 0;
+
+    size_t size() const;
+
+    Document *GetHeapBegin();
+
+    const Document *GetHeapBegin() const;
+};
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+// Разреженный массив с дешёвым копированием. Значения лежат в листьях дерева
+// с ветвлением NODE_SIZE, копии массива делят узлы. Изменение копирует узлы на пути
+// к значению, которые видны другим копиям, поэтому сделанные ранее копии не меняются
+// и их можно читать из других потоков, пока массив изменяется.
+// Общие узлы определяются по счётчикам ссылок, поэтому копировать, изменять и уничтожать
+// копии массива должен один поток, а остальные потоки только читают их
+template<typename T, size_t NodeBits = 6>
+class VersionedArray {
+public:
+    static constexpr size_t NODE_BITS = NodeBits;
+    static constexpr size_t NODE_SIZE = size_t{1} << NODE_BITS;
+
+    // Число значений в массиве
+    size_t size() const;
+
+    bool empty() const;
+
+    // Вернёт nullptr, если значения с индексом index нет
+    const T *Find(uint32_t index) const;
+
+    // Бросит std::out_of_range, если значения с индексом index нет
+    const T &at(uint32_t index) const;
+
+    // Без проверки наличия значения. Для отсутствующего значения вернёт T{}
+    const T &operator[](uint32_t index) const;
+
+    // Вернёт значение для изменения, создав его при необходимости
+    T &GetMutable(uint32_t index);
+
+    void Erase(uint32_t index);
+
+    // Вызовет action(index, value) для всех значений по возрастанию индексов
+    template<typename Action>
+    void ForEach(Action action) const;
+
+private:
+    static constexpr uint32_t INDEX_MASK = NODE_SIZE - 1;
+
+    struct Node {
+    };
+
+    struct Inner : Node {
+        std::array<std::shared_ptr<Node>, NODE_SIZE> children;
+    };
+
+    struct Leaf : Node {
+        std::array<T, NODE_SIZE> values{};
+        uint64_t present = 0; // Битовая маска имеющихся значений
+    };
+
+    std::shared_ptr<Node> root_;
+    size_t height_ = 0; // Число уровней внутренних узлов над листьями
+    size_t size_ = 0;
+
+    // Помещается ли индекс в дерево текущей высоты
+    bool Covers(uint32_t index) const;
+
+    // Лист со значением index или nullptr
+    const Leaf *FindLeaf(uint32_t index) const;
+
+    // Сделает узел доступным для изменения: создаст его или скопирует, если он общий
+    template<typename NodeType>
+    static NodeType &MakeOwned(std::shared_ptr<Node> &node);
+
+    template<typename Action>
+    static void ForEachInNode(const Node &node, size_t level, uint32_t first_index, Action &action);
+};
+
+template<typename T, size_t NodeBits>
+size_t VersionedArray<T, NodeBits>::size() const {
+    return size_;
+}
+
+template<typename T, size_t NodeBits>
+bool VersionedArray<T, NodeBits>::empty() const {
+    return size_ == 0;
+}
+
+template<typename T, size_t NodeBits>
+const T *VersionedArray<T, NodeBits>::Find(uint32_t index) const {
+    const Leaf *leaf = FindLeaf(index);
+    const uint32_t position = index & INDEX_MASK;
+    if (leaf == nullptr || (leaf->present >> position & 1) == 0) {
+        return nullptr;
+    }
+    return &leaf->values[position];
+}
+
+template<typename T, size_t NodeBits>
+const T &VersionedArray<T, NodeBits>::at(uint32_t index) const {
+    const T *value = Find(index);
+    if (value == nullptr) {
+        throw std::out_of_range("VersionedArray index is out of range");
+    }
+    return *value;
+}
+
+template<typename T, size_t NodeBits>
+const T &VersionedArray<T, NodeBits>::operator[](uint32_t index) const {
+    const Leaf *leaf = FindLeaf(index);
+    if (leaf == nullptr) {
+        static const T default_value{};
+        return default_value;
+    }
+    // Незанятые ячейки листа хранят T{}: Erase сбрасывает значение
+    return leaf->values[index & INDEX_MASK];
+}
+
+template<typename T, size_t NodeBits>
+T &VersionedArray<T, NodeBits>::GetMutable(uint32_t index) {
+    if (!root_) {
+        root_ = std::make_shared<Leaf>();
+    }
+    while (!Covers(index)) {
+        auto root = std::make_shared<Inner>();
+        root->children[0] = std::move(root_);
+        root_ = std::move(root);
+        ++height_;
+    }
+
+    std::shared_ptr<Node> *node = &root_;
+    for (size_t level = height_; level > 0; --level) {
+        Inner &inner = MakeOwned<Inner>(*node);
+        node = &inner.children[index >> (level * NODE_BITS) & INDEX_MASK];
+    }
+    Leaf &leaf = MakeOwned<Leaf>(*node);
+    const uint32_t position = index & INDEX_MASK;
+    if ((leaf.present >> position & 1) == 0) {
+        leaf.present |= uint64_t{1} << position;
+        ++size_;
+    }
+    return leaf.values[position];
+}
+
+template<typename T, size_t NodeBits>
+void VersionedArray<T, NodeBits>::Erase(uint32_t index) {
+    if (Find(index) == nullptr) {
+        return;
+    }
+    std::shared_ptr<Node> *node = &root_;
+    for (size_t level = height_; level > 0; --level) {
+        Inner &inner = MakeOwned<Inner>(*node);
+        node = &inner.children[index >> (level * NODE_BITS) & INDEX_MASK];
+    }
+    Leaf &leaf = MakeOwned<Leaf>(*node);
+    const uint32_t position = index & INDEX_MASK;
+    leaf.present &= ~(uint64_t{1} << position);
+    leaf.values[position] = T{};
+    --size_;
+    if (leaf.present == 0) {
+        node->reset(); // Пустой лист освобождается, внутренние узлы остаются
+    }
+}
+
+template<typename T, size_t NodeBits>
+template<typename Action>
+void VersionedArray<T, NodeBits>::ForEach(Action action) const {
+    if (root_) {
+        ForEachInNode(*root_, height_, 0, action);
+    }
+}
+
+template<typename T, size_t NodeBits>
+bool VersionedArray<T, NodeBits>::Covers(uint32_t index) const {
+    const size_t bits = (height_ + 1) * NODE_BITS;
+    return bits >= 32 || (index >> bits) == 0;
+}
+
+template<typename T, size_t NodeBits>
+const typename VersionedArray<T, NodeBits>::Leaf *VersionedArray<T, NodeBits>::FindLeaf(uint32_t index) const {
+    if (!root_ || !Covers(index)) {
+        return nullptr;
+    }
+    const Node *node = root_.get();
+    for (size_t level = height_; level > 0 && node != nullptr; --level) {
+        node = static_cast<const Inner *>(node)->children[index >> (level * NODE_BITS) & INDEX_MASK].get();
+    }
+    return static_cast<const Leaf *>(node);
+}
+
+template<typename T, size_t NodeBits>
+template<typename NodeType>
+NodeType &VersionedArray<T, NodeBits>::MakeOwned(std::shared_ptr<Node> &node) {
+    if (!node) {
+        node = std::make_shared<NodeType>();
+    } else if (node.use_count() > 1) {
+        node = std::make_shared<NodeType>(static_cast<const NodeType &>(*node));
+    }
+    return static_cast<NodeType &>(*node);
+}
+
+template<typename T, size_t NodeBits>
+template<typename Action>
+void VersionedArray<T, NodeBits>::ForEachInNode(const Node &node, size_t level, uint32_t first_index, Action &action) {
+    if (level == 0) {
+        const auto &leaf = static_cast<const Leaf &>(node);
+        for (uint32_t position = 0; position < NODE_SIZE; ++position) {
+            if ((leaf.present >> position & 1) != 0) {
+                action(first_index + position, leaf.values[position]);
+            }
+        }
+        return;
+    }
+    const auto &inner = static_cast<const Inner &>(node);
+    for (uint32_t position = 0; position < NODE_SIZE; ++position) {
+        if (inner.children[position]) {
+            ForEachInNode(*inner.children[position], level - 1,
+                          first_index + (position << (level * NODE_BITS)), action);
+        }
+    }
+}